@@ -0,0 +1,103 @@
+#ifndef BINARY_PROTOCOL_H
+#define BINARY_PROTOCOL_H
+
+#include <Arduino.h>
+
+// Compact binary framing, accepted on the same port as the !!...## text:
+//
+//   [0xB5] [id] [len] [payload: len bytes] [crc16 lo] [crc16 hi]
+//
+// The magic byte is outside ASCII, so the framer tells the two apart on the
+// first byte. CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) covers id, len and
+// payload. Multi-byte payload fields are little-endian.
+//
+// Replies are binary acks: [0xB5] [id | 0x80] [1] [status] [crc16].
+
+#define BIN_MAGIC        0xB5
+#define BIN_MAX_PAYLOAD  255
+#define BIN_ACK_FLAG     0x80
+
+enum BinaryCommandId : uint8_t {
+    // count u16, speed u8, r u8, g u8, b u8, brightness u8, size u8  (8 bytes),
+    // then optionally passes u8 (9 bytes), passes u8, ttlMs u32 (13 bytes)
+    // or passes u8, ttlMs u32, group u8 (14 bytes)
+    BIN_ADD_STAR_CENTER       = 0x01,
+    // durationMs u32, speedMultiplier x100 u16  (6 bytes)
+    BIN_BUILDUP_CLIMAX_CENTER = 0x02,
+    // durationMs u32, spiralSpeed x100 u16, speedMultiplier x100 u16,
+    // verticalBias x100 u16  (10 bytes)
+    BIN_START_CLIMAX_CENTER   = 0x03,
+    // no payload
+    BIN_PING                  = 0x04,
+    // curtain u8, offset u16, then 1..125 strip positions u16: one chunk of
+    // a custom wiring table (see mappingLoadCustom)
+    BIN_WIRING_MAP            = 0x05,
+
+    // Controller-to-controller ring link only (see shard.h)
+    // frame u32, x f32 (global column), vx f32, bright f32,
+    // row u8, r u8, g u8, b u8, size u8, flags u8, passes u8,
+    // ttl left ms u32, group u8  (28 bytes)
+    BIN_STAR_HANDOFF          = 0x10,
+    // frame u32, periodUs u32, origin node u8, clockUs u64  (17 bytes)
+    BIN_SYNC                  = 0x11,
+};
+
+#define BIN_HANDOFF_LEN 28
+#define BIN_SYNC_LEN    17
+
+enum BinaryStatus : uint8_t {
+    BIN_STATUS_OK          = 0,
+    BIN_STATUS_ERROR       = 1,   // handler rejected the parameters
+    BIN_STATUS_UNKNOWN_ID  = 2,
+    BIN_STATUS_BAD_LENGTH  = 3,
+    BIN_STATUS_BAD_CRC     = 4,
+};
+
+// Whether id is a known frame and len a payload size it can have. The framer
+// uses this to drop a stray 0xB5 straight away instead of swallowing up to
+// 255 bytes waiting for a CRC; handlers still check the exact layout.
+bool binHeaderValid(uint8_t id, uint8_t len);
+
+uint16_t crc16Update(uint16_t crc, uint8_t b);
+uint16_t crc16(const uint8_t *data, size_t len, uint16_t crc = 0xFFFF);
+
+// Write one framed binary message
+void sendBinaryFrame(Print &out, uint8_t id, const uint8_t *payload, uint8_t len);
+
+// Write a one-byte status ack for command id
+void sendBinaryAck(Print &out, uint8_t id, uint8_t status);
+
+inline uint16_t binReadU16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+inline uint32_t binReadU32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+inline float binReadF32(const uint8_t *p) {
+    uint32_t u = binReadU32(p);
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+inline void binWriteU16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+inline void binWriteU32(uint8_t *p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+}
+
+inline void binWriteF32(uint8_t *p, float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    binWriteU32(p, u);
+}
+
+#endif // BINARY_PROTOCOL_H
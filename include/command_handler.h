@@ -4,16 +4,24 @@
 #include <Arduino.h>
 #include "../lib/CmdLib.h"
 #include "commands/base_command_handler.h"
+#include "command_registry.h"
+#include "serial_framer.h"
 
 // Initialize command handler
 void commandHandlerInit();
 
-// Register a handler
+// Register a handler's commands in the dispatch registry
 void registerHandler(BaseCommandHandler *handler);
 
 // Process incoming serial data
 void processSerialCommands();
 
+// Frames (text, binary or rejected) seen on the command port so far
+unsigned long commandFramesReceived();
+
+// The command port's framer, for its diagnostic counters (STATS)
+const SerialFramer &commandFramer();
+
 // Handle a parsed command using registered handlers
 void handleCommand(const cmdlib::Command &cmd);
 
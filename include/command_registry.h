@@ -0,0 +1,69 @@
+#ifndef COMMAND_REGISTRY_H
+#define COMMAND_REGISTRY_H
+
+#include <Arduino.h>
+#include "../lib/CmdLib.h"
+#include "commands/base_command_handler.h"
+
+// Command name / binary id -> handler method, resolved with one hash lookup.
+// Entries are added at registration time (when the table may grow); dispatch
+// never allocates and costs the same no matter how many commands exist.
+class CommandRegistry {
+public:
+    typedef void (BaseCommandHandler::*TextMethod)(const cmdlib::Command &cmd, cmdlib::Command &response);
+    typedef void (BaseCommandHandler::*BinaryMethod)(const uint8_t *payload, uint8_t len, cmdlib::Command &response);
+
+    CommandRegistry() : slots(nullptr), capacity(0), count(0), binaryCount(0) {
+        memset(binarySlot, 0xFF, sizeof(binarySlot));
+    }
+
+    // Map a text command name (string literal) to a handler method.
+    // Returns false for a duplicate name or if out of memory.
+    template <class H>
+    bool add(const char *name, H *handler, void (H::*method)(const cmdlib::Command &, cmdlib::Command &)) {
+        return addText(name, handler, static_cast<TextMethod>(method));
+    }
+
+    // Map a binary command id to a handler method; false if the id is taken
+    template <class H>
+    bool addBinary(uint8_t id, H *handler, void (H::*method)(const uint8_t *, uint8_t, cmdlib::Command &)) {
+        return addBinaryEntry(id, handler, static_cast<BinaryMethod>(method));
+    }
+
+    // Run the handler for cmd.command(); false if nothing is registered
+    bool dispatch(const cmdlib::Command &cmd, cmdlib::Command &response) const;
+    bool dispatchBinary(uint8_t id, const uint8_t *payload, uint8_t len, cmdlib::Command &response) const;
+
+    bool contains(const char *name) const { return find(name) != nullptr; }
+    int size() const { return count + binaryCount; }
+
+    static uint32_t hashName(const char *name);
+
+private:
+    struct TextEntry {
+        uint32_t hash;
+        const char *name;        // nullptr marks an empty slot
+        BaseCommandHandler *handler;
+        TextMethod method;
+    };
+    struct BinaryEntry {
+        BaseCommandHandler *handler;
+        BinaryMethod method;
+    };
+
+    static const int MAX_BINARY = 32;
+
+    bool addText(const char *name, BaseCommandHandler *handler, TextMethod method);
+    bool addBinaryEntry(uint8_t id, BaseCommandHandler *handler, BinaryMethod method);
+    bool grow();
+    const TextEntry *find(const char *name) const;
+
+    TextEntry *slots;            // open addressing, capacity is a power of two
+    uint16_t capacity;
+    uint16_t count;
+    uint8_t binarySlot[256];     // id -> index into binaryEntries, 0xFF = none
+    BinaryEntry binaryEntries[MAX_BINARY];
+    uint8_t binaryCount;
+};
+
+#endif // COMMAND_REGISTRY_H
@@ -3,49 +3,59 @@
 
 #include <Arduino.h>
 #include "../../lib/CmdLib.h"
+#include "../binary_protocol.h"
+
+class CommandRegistry;
 
 // Base class for all command handlers
 class BaseCommandHandler {
 public:
     virtual ~BaseCommandHandler() {}
 
-    // Check if this handler can process the given command type
-    virtual bool canHandle(const String &command) const = 0;
-
-    // Process the command and return response
-    virtual void handle(const cmdlib::Command &cmd, cmdlib::Command &response) = 0;
+    // Map each command name (and binary id, see binary_protocol.h) this
+    // handler serves to one of its methods
+    virtual void registerCommands(CommandRegistry &registry) = 0;
 
     // Get handler name for debugging
-    virtual String getName() const = 0;
+    virtual const char *getName() const = 0;
 
 protected:
     // Helper to build response
-    void buildResponse(cmdlib::Command &resp, const String &command, const String &dst ) {
+    void buildResponse(cmdlib::Command &resp, const char *command, const char *dst) {
         resp.clear();
-        if (dst != "" )
+        if (dst[0] != '\0')
             resp.addHeader(dst);
-        resp.msgKind = "CONFIRM";
-        resp.command = command;
+        resp.setMsgKind("CONFIRM");
+        resp.setCommand(command);
     }
 
     // Helper to build request
-    void buildRequest(cmdlib::Command &resp, const String &command, const String &dst ) {
+    void buildRequest(cmdlib::Command &resp, const char *command, const char *dst) {
         resp.clear();
-        if (dst != "" )
+        if (dst[0] != '\0')
             resp.addHeader(dst);
-        resp.msgKind = "REQUEST";
-        resp.command = command;
+        resp.setMsgKind("REQUEST");
+        resp.setCommand(command);
     }
 
     // Helper to build error response
-    void buildError(cmdlib::Command &resp, const String &command, const String &message, const String &dst) {
+    void buildError(cmdlib::Command &resp, const char *command, const char *message, const char *dst) {
         resp.clear();
-        if (dst != "" )
+        if (dst[0] != '\0')
             resp.addHeader(dst);
-        resp.command = command;
-        resp.msgKind = "ERROR";
+        resp.setCommand(command);
+        resp.setMsgKind("ERROR");
         resp.setNamed("message", message);
     }
+
+    // Error for a binary payload of the wrong size; the status field makes
+    // the binary ack report BIN_STATUS_BAD_LENGTH instead of BIN_STATUS_ERROR
+    void buildLengthError(cmdlib::Command &resp, const char *command, uint8_t len) {
+        char msg[48];
+        snprintf(msg, sizeof(msg), "Bad payload length: %u bytes", len);
+        buildError(resp, command, msg, "MASTER");
+        resp.setNamed("status", (int)BIN_STATUS_BAD_LENGTH);
+    }
 };
 
 #endif // BASE_COMMAND_HANDLER_H
\ No newline at end of file
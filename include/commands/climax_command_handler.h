@@ -2,22 +2,32 @@
 #define CLIMAX_COMMAND_HANDLER_H
 
 #include "base_command_handler.h"
+#include "../command_registry.h"
+#include "../binary_protocol.h"
 
 class ClimaxCommandHandler : public BaseCommandHandler {
 public:
-    bool canHandle(const String &command) const override {
-        return command == "BUILDUP_CLIMAX_CENTER" || command == "START_CLIMAX_CENTER";
+    void registerCommands(CommandRegistry &registry) override {
+        registry.add("BUILDUP_CLIMAX_CENTER", this, &ClimaxCommandHandler::handleBuildUp);
+        registry.add("START_CLIMAX_CENTER", this, &ClimaxCommandHandler::handleStart);
+        registry.addBinary(BIN_BUILDUP_CLIMAX_CENTER, this, &ClimaxCommandHandler::handleBuildUpBinary);
+        registry.addBinary(BIN_START_CLIMAX_CENTER, this, &ClimaxCommandHandler::handleStartBinary);
     }
-    
-    String getName() const override {
+
+
+    const char *getName() const override {
         return "ClimaxHandler";
     }
     
-    void handle(const cmdlib::Command &cmd, cmdlib::Command &response) override;
-
 private:
     void handleBuildUp(const cmdlib::Command &cmd, cmdlib::Command &response);
     void handleStart(const cmdlib::Command &cmd, cmdlib::Command &response);
+    void handleBuildUpBinary(const uint8_t *payload, uint8_t len, cmdlib::Command &response);
+    void handleStartBinary(const uint8_t *payload, uint8_t len, cmdlib::Command &response);
+    void startBuildUp(const char *command, const char *src, float duration, float speedMultiplier,
+                      cmdlib::Command &response);
+    void startSpiral(const char *command, const char *src, float duration, float spiralSpeed,
+                     float speedMultiplier, float bias, cmdlib::Command &response);
 };
 
 #endif // CLIMAX_COMMAND_HANDLER_H
\ No newline at end of file
@@ -2,21 +2,26 @@
 #define STAR_COMMAND_HANDLER_H
 
 #include "base_command_handler.h"
+#include "../command_registry.h"
+#include "../binary_protocol.h"
 
 class StarCommandHandler : public BaseCommandHandler {
 public:
-    bool canHandle(const String &command) const override {
-        return (command == "ADD_STAR_CENTER");
+    void registerCommands(CommandRegistry &registry) override {
+        registry.add("ADD_STAR_CENTER", this, &StarCommandHandler::handleAdd);
+        registry.addBinary(BIN_ADD_STAR_CENTER, this, &StarCommandHandler::handleAddBinary);
     }
-    
-    String getName() const override {
+
+
+    const char *getName() const override {
         return "StarHandler";
     }
     
-    void handle(const cmdlib::Command &cmd, cmdlib::Command &response) override;
-
 private:
     void handleAdd(const cmdlib::Command &cmd, cmdlib::Command &response);
+    void handleAddBinary(const uint8_t *payload, uint8_t len, cmdlib::Command &response);
+    void addStars(const char *command, const char *src, int count, int speed, int hexColor,
+                  int brightness, int size, int passes, long ttl, int group, cmdlib::Command &response);
 };
 
 #endif // STAR_COMMAND_HANDLER_H
\ No newline at end of file
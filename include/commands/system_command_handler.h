@@ -0,0 +1,40 @@
+#ifndef SYSTEM_COMMAND_HANDLER_H
+#define SYSTEM_COMMAND_HANDLER_H
+
+#include "base_command_handler.h"
+#include "../command_registry.h"
+#include "../binary_protocol.h"
+
+class SystemCommandHandler : public BaseCommandHandler {
+public:
+    void registerCommands(CommandRegistry &registry) override {
+        registry.add("FRAME_RATE", this, &SystemCommandHandler::handleFrameRate);
+        registry.add("WIRING", this, &SystemCommandHandler::handleWiring);
+        registry.addBinary(BIN_WIRING_MAP, this, &SystemCommandHandler::handleWiringMapBinary);
+        registry.add("STATS", this, &SystemCommandHandler::handleStats);
+        registry.add("IDLE", this, &SystemCommandHandler::handleIdle);
+        registry.add("NODE", this, &SystemCommandHandler::handleNode);
+        registry.add("OUTPUT", this, &SystemCommandHandler::handleOutput);
+        registry.add("POWER", this, &SystemCommandHandler::handlePower);
+        registry.add("LOD", this, &SystemCommandHandler::handleLod);
+        registry.add("SEED", this, &SystemCommandHandler::handleSeed);
+    }
+
+    const char *getName() const override {
+        return "SystemHandler";
+    }
+
+private:
+    void handleFrameRate(const cmdlib::Command &cmd, cmdlib::Command &response);
+    void handleWiring(const cmdlib::Command &cmd, cmdlib::Command &response);
+    void handleWiringMapBinary(const uint8_t *payload, uint8_t len, cmdlib::Command &response);
+    void handleStats(const cmdlib::Command &cmd, cmdlib::Command &response);
+    void handleIdle(const cmdlib::Command &cmd, cmdlib::Command &response);
+    void handleNode(const cmdlib::Command &cmd, cmdlib::Command &response);
+    void handleOutput(const cmdlib::Command &cmd, cmdlib::Command &response);
+    void handlePower(const cmdlib::Command &cmd, cmdlib::Command &response);
+    void handleLod(const cmdlib::Command &cmd, cmdlib::Command &response);
+    void handleSeed(const cmdlib::Command &cmd, cmdlib::Command &response);
+};
+
+#endif // SYSTEM_COMMAND_HANDLER_H
@@ -14,15 +14,47 @@
 // Per-curtain row inversion (set in config.cpp)
 extern bool invertCurtain[CURTAINS];
 
+// star array capacity (MAX_STARS); override with -DSTAR_CAPACITY=... if RAM allows
+#ifndef STAR_CAPACITY
+#define STAR_CAPACITY 500
+#endif
+
+// bytes per star in the StarStore: x, vx, bright, expires, then 8 u8 fields
+#define STAR_BYTES (3 * sizeof(float) + sizeof(uint32_t) + 8 * sizeof(uint8_t))
+
+// The 12.4 canvas: a second full frame beside the driver's 8-bit one
+#define CANVAS_BYTES ((size_t)NUM_PIXELS * 3 * sizeof(uint16_t))
+
+// RAM shared by DMAMEM buffers and the malloc heap, checked at compile time
+// against the canvas, the LED DMA buffer and the star store. 512 KB is RAM2
+// (OCRAM) on Teensy 4.x; override with -DHEAP_RAM_BYTES=... for other boards.
+#ifndef HEAP_RAM_BYTES
+#define HEAP_RAM_BYTES (512u * 1024u)
+#endif
+
+// stars whose random properties are drawn in one go by starsSpawn (stack cost 16 bytes each)
+#define STAR_SPAWN_CHUNK 32
+
 // runtime tunables (modifiable via serial reader)
 extern int activeStarCount; // number of stars currently active (<= MAX_STARS)
 extern const int MAX_STARS; // hard cap for allocation
 extern float minSpeedColsPerSec; // min speed (cols/sec)
 extern float maxSpeedColsPerSec; // max speed (cols/sec)
 extern float fadeFactor; // per-frame fade (0..1)
+extern float outputGamma; // output stage gamma (1.0 = linear)
+extern bool outputDither; // temporal dither of the 4 sub-LSB canvas bits
+extern unsigned long powerLimitMa; // supply budget for the whole wall, 0 = unlimited
 extern unsigned long frameTargetMs;
 extern bool randomRows;
 extern bool wrapStars;
+extern bool idleScreensaver; // twinkle while idle and the master stopped pinging
+extern uint32_t prngBootSeed; // fixed PRNG seed at boot for repeatable shows, 0 = seed from noise
+
+// multi-controller layout (see shard.h; runtime: NODE command)
+extern uint8_t nodeIndex;        // this controller's position in the ring
+extern uint8_t nodeCount;        // controllers sharing the canvas (1 = standalone)
+extern int nodeColumnOffset;     // first global column drawn here
+extern int globalWidth;          // columns across all controllers
 
 // default star color (modifiable)
 extern uint8_t STAR_R, STAR_G, STAR_B;
@@ -31,4 +63,26 @@ extern uint8_t STAR_R, STAR_G, STAR_B;
 extern const byte pinList[CURTAINS];
 
 #define CommunicationSerial Serial1   // or Serial1, Serial2, etc.
+#define LogSerial Serial               // debug log output (see log.h)
+#define ShardLinkSerial Serial2         // controller ring link (see shard.h)
+#define SHARD_LINK_BAUD 2000000
+
+// LED current model for the power estimate (WS2812B-style)
+#define LED_CHANNEL_MA 20    // one channel at full level
+#define LED_IDLE_UA 600      // quiescent draw per LED, microamps
+
+// Adaptive level of detail (see lod.h): render cost (climax, fade, stars and
+// copy) as % of the frame period. The rest of the period goes to show()'s
+// buffer copy, serial commands and the log drain.
+#define LOD_BUDGET_PCT 75    // above this, count towards less detail
+#define LOD_RESTORE_PCT 40   // below this, count towards more detail
+#define LOD_UP_FRAMES 3      // consecutive frames over budget to drop a level
+#define LOD_DOWN_FRAMES 60   // consecutive frames of headroom to restore one
+#define LOD_BACKOFF_MAX 32   // a restore that keeps failing waits up to this many times longer
+
+// ms between screensaver twinkles while idle
+#define IDLE_TWINKLE_MS 1500
+
+// max serial bytes consumed per processSerialCommands() call
+#define SERIAL_BYTE_BUDGET 256
 #endif // OCTO_CONFIG_H
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef EASING_H
+#define EASING_H
+
+#include <Arduino.h>
+
+// Fixed-size lookup tables for the animation math that would otherwise call
+// libm per star per frame. Tables are built once by easingInit(); lookups
+// are a multiply, an index and a linear interpolation.
+
+#define SINE_LUT_BITS 8                     // entries per turn = 1 << SINE_LUT_BITS
+#define SINE_LUT_SIZE (1 << SINE_LUT_BITS)
+#define EASE_LUT_SIZE 256                   // samples over t = 0..1
+
+extern float sineLut[SINE_LUT_SIZE + 1];    // sin over one turn, plus a guard entry
+extern float easeIn15Lut[EASE_LUT_SIZE + 1]; // t^1.5
+
+// Build the tables; safe to call more than once
+void easingInit();
+
+// sin(2*pi*turns) for any turns, positive or negative
+static inline float sinTurns(float turns) {
+    // 16.16 phase: the integer part wraps for free
+    uint32_t phase = (uint32_t)(int32_t)(turns * 65536.0f);
+    uint32_t idx = (phase & 0xFFFF) >> (16 - SINE_LUT_BITS);
+    float frac = (float)(phase & ((1u << (16 - SINE_LUT_BITS)) - 1)) * (1.0f / (1u << (16 - SINE_LUT_BITS)));
+    float a = sineLut[idx];
+    return a + (sineLut[idx + 1] - a) * frac;
+}
+
+// Sample a 0..1 ease table at t, clamped to 0..1
+static inline float easeLookup(const float *lut, float t) {
+    if (t <= 0.0f) return lut[0];
+    if (t >= 1.0f) return lut[EASE_LUT_SIZE];
+    float pos = t * EASE_LUT_SIZE;
+    int idx = (int)pos;
+    float a = lut[idx];
+    return a + (lut[idx + 1] - a) * (pos - idx);
+}
+
+static inline float easeIn15(float t) {
+    return easeLookup(easeIn15Lut, t);
+}
+
+// Named curves for animation tracks (tween.h); all map 0 -> 0 and 1 -> 1
+enum EaseCurve : uint8_t {
+    EASE_LINEAR,
+    EASE_IN_15,         // t^1.5
+    EASE_IN_QUAD,
+    EASE_OUT_QUAD,
+    EASE_IN_OUT_SINE,
+    EASE_HOLD,          // keep the start value until the end of the segment
+};
+
+static inline float easeApply(uint8_t curve, float t) {
+    switch (curve) {
+        case EASE_IN_15:       return easeIn15(t);
+        case EASE_IN_QUAD:     return t * t;
+        case EASE_OUT_QUAD:    return t * (2.0f - t);
+        case EASE_IN_OUT_SINE: return 0.5f - 0.5f * sinTurns(t * 0.5f + 0.25f);
+        case EASE_HOLD:        return t >= 1.0f ? 1.0f : 0.0f;
+        default:               return t;
+    }
+}
+
+#endif // EASING_H
@@ -0,0 +1,32 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <Arduino.h>
+
+// Paces loop() against absolute deadlines (frame N starts at start + N * period)
+// instead of sleeping a fixed time after each frame.
+
+void frameSchedulerInit();
+
+// Change the target frame rate at runtime; returns false if fps is out of range
+bool frameSchedulerSetFps(float fps);
+float frameSchedulerFps();
+unsigned long frameSchedulerPeriodUs();
+
+// Call once rendering for the frame that started at frameStartMicros is done.
+// Counts an overrun if the frame ran past its deadline.
+void frameSchedulerEndFrame(unsigned long frameStartMicros);
+
+// Spend the slack until the next deadline running idleWork (e.g. serial polling)
+void frameSchedulerWait(void (*idleWork)());
+
+// Externally clocked (sharded follower): each frame is started by
+// frameSchedulerAlign(), and the scheduler only falls back to its own
+// deadline after two periods without one.
+void frameSchedulerSetExternalClock(bool external);
+void frameSchedulerAlign();
+
+unsigned long frameSchedulerOverruns();
+unsigned long frameSchedulerLastFrameUs();
+
+#endif // FRAME_SCHEDULER_H
@@ -0,0 +1,23 @@
+#ifndef IDLE_H
+#define IDLE_H
+
+#include <Arduino.h>
+
+// Idle mode: with no stars, no climax running and a black frame already on
+// the LEDs, loop() skips rendering and show altogether and sleeps between
+// serial polls. Any frame on the command port wakes it for the next frame.
+
+// Decide at the start of a frame whether it can be skipped
+bool idleUpdate();
+bool idleActive();
+
+// Slack-time sleep: waits for the next interrupt while idle, otherwise a no-op
+void idleSleep();
+
+// While idle and the master has stopped pinging, occasionally light a dim
+// pixel that the normal fade takes away again
+void idleScreensaverTick();
+
+unsigned long idleFrames();
+
+#endif // IDLE_H
@@ -0,0 +1,33 @@
+#ifndef LOD_H
+#define LOD_H
+
+#include <Arduino.h>
+
+// Adaptive level of detail. Each rendered frame's render cost is compared with
+// the frame period; sustained overruns step the level up (less detail),
+// sustained headroom steps it back down. The star renderer reads the
+// current level's limits from lodLimits.
+
+struct LodLimits {
+    uint8_t maxTrail;   // trail segments drawn per star (Star size is capped to this)
+    uint8_t snapBelow;  // trail segments dimmer than this land on one pixel, unblended
+    uint8_t faintBelow; // trail pixels dimmer than this (0..255) are not drawn
+    uint8_t cullBelow;  // stars whose peak channel is dimmer than this are not drawn
+};
+
+#define LOD_LEVELS 7
+
+extern LodLimits lodLimits;     // limits of the current level
+
+// Feed the render cost of the frame just finished (climax to copy, without
+// the show and serial work that detail cannot shorten)
+void lodUpdate(unsigned long frameUs, unsigned long periodUs);
+
+uint8_t lodLevel();
+// Pin a level (turns adaptation off) or hand control back to the controller
+void lodSetLevel(uint8_t level);
+void lodSetAuto(bool enabled);
+bool lodAuto();
+unsigned long lodChanges();
+
+#endif // LOD_H
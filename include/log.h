@@ -0,0 +1,63 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+
+// Deferred logging. LOG_* calls below LOG_LEVEL compile to nothing; the rest
+// format one line into a lock-free ring buffer, which logDrain() empties to
+// LogSerial only in frame slack time and only as fast as the port accepts
+// without blocking. When the ring is full, messages are dropped and counted.
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// ring size in bytes, power of two
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE 2048
+#endif
+
+// longest single formatted line
+#ifndef LOG_LINE_MAX
+#define LOG_LINE_MAX 120
+#endif
+
+void logWrite(uint8_t level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+// Move queued text to LogSerial without blocking; call from frame slack
+void logDrain();
+
+uint32_t logDroppedCount();
+uint32_t logQueuedBytes();
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) logWrite(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) logWrite(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) logWrite(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) logWrite(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+
+#endif // LOG_H
@@ -3,6 +3,22 @@
 
 #include "config.h"
 
+// How a curtain's LEDs are chained, in output (strip) order
+enum CurtainWiring : uint8_t {
+    WIRING_COLUMN_MAJOR = 0,     // col * CURTAIN_HEIGHT + row (original layout)
+    WIRING_ROW_MAJOR,            // row * CURTAIN_WIDTH + col
+    WIRING_SERPENTINE_COLUMNS,   // column-major, every other column runs bottom-up
+    WIRING_SERPENTINE_ROWS,      // row-major, every other row runs right-to-left
+    WIRING_CUSTOM,               // per-LED table loaded with mappingLoadCustom()
+    WIRING_COUNT
+};
+
+// Per-curtain wiring (set in config.cpp, changeable via WIRING command)
+extern CurtainWiring curtainWiring[CURTAINS];
+
+// (x, row) -> global output index, rebuilt by mappingBuild()
+extern uint16_t pixelMap[TOTAL_HEIGHT * TOTAL_WIDTH];
+
 inline int localIndexInCurtain(int col, int row) {
     return col * CURTAIN_HEIGHT + row;
 }
@@ -11,4 +27,27 @@ inline int globalOctoIndex(int curtainIdx, int localIndex) {
     return curtainIdx * LEDS_PER_CURTAIN + localIndex;
 }
 
-#endif // MAPPING_H
\ No newline at end of file
+// Lookup row for one canvas row, indexed by global column
+inline const uint16_t *pixelMapRow(int row) {
+    return pixelMap + row * TOTAL_WIDTH;
+}
+
+// Rebuild the lookup table from curtainWiring[] and invertCurtain[]
+void mappingBuild();
+
+// Re-wire one curtain and rebuild; false if curtain or wiring is out of range,
+// or WIRING_CUSTOM is asked for before a table was loaded for the curtain
+bool mappingSetCurtain(int curtainIdx, CurtainWiring wiring, bool invert);
+
+// Load a curtain's custom table in chunks, in order from offset 0. entries[i]
+// is the strip position (0..LEDS_PER_CURTAIN-1) of cell offset + i, cells
+// numbered localIndexInCurtain(col, row). The chunk that completes the table
+// checks every position is used exactly once, then wires the curtain to it
+// and sets applied. False (and the partial table dropped) on a bad chunk.
+bool mappingLoadCustom(int curtainIdx, int offset, const uint16_t *entries, int count, bool &applied);
+bool mappingHasCustom(int curtainIdx);
+
+const char *wiringName(CurtainWiring wiring);
+bool wiringFromName(const char *name, CurtainWiring &out);
+
+#endif // MAPPING_H
@@ -4,9 +4,19 @@
 #include <OctoWS2811.h>
 #include "config.h"
 
+// On Teensy 4.x OctoWS2811 keeps drawingMemory as plain 3-byte pixels, strip
+// after strip, and only transposes in show(). The renderer can then draw
+// straight into it (needs WS2811_RGB so byte order matches pixBuf).
+#if defined(__IMXRT1062__) || defined(OCTOWS2811_LINEAR_DRAWBUFFER)
+#define OCTO_ZERO_COPY 1
+#define OCTO_MEMORY_WORDS ((LEDS_PER_CURTAIN * CURTAINS * 3 + 3) / 4)
+#else
+#define OCTO_MEMORY_WORDS (LEDS_PER_CURTAIN * 6)
+#endif
+
 // OctoWS memory: sized by LEDS_PER_CURTAIN
-extern DMAMEM int displayMemory[LEDS_PER_CURTAIN * 6];
-extern int drawingMemory[LEDS_PER_CURTAIN * 6];
+extern DMAMEM int displayMemory[OCTO_MEMORY_WORDS];
+extern int drawingMemory[OCTO_MEMORY_WORDS];
 
 // leds object and helpers
 extern OctoWS2811 leds;
@@ -15,4 +25,11 @@ void octoBegin();
 void octoShow();
 void octoSetPixel(int globalIdx, uint8_t r, uint8_t g, uint8_t b);
 
-#endif // OCTO_WRAPPER_H
\ No newline at end of file
+// Drawing buffer as NUM_PIXELS * 3 RGB bytes, or nullptr if the driver
+// layout can't be drawn into directly
+uint8_t *octoDrawBuffer();
+
+// Copy one curtain of packed RGB bytes into the driver
+void octoWriteCurtain(int curtainIdx, const uint8_t *rgb);
+
+#endif // OCTO_WRAPPER_H
@@ -0,0 +1,44 @@
+#ifndef PRNG_H
+#define PRNG_H
+
+#include <Arduino.h>
+
+// PCG32 (XSH-RR) generator for everything animated: a 64-bit multiply-add
+// and a rotate per 32-bit word, no division. Ranges use Lemire's
+// multiply-shift instead of a modulo. The same seed always gives the same
+// sequence, so a show replayed with the same SEED spawns the same stars.
+
+struct PrngState {
+    uint64_t state;
+    uint64_t inc;
+};
+
+extern PrngState prng;
+
+// Restart the sequence; the seed is kept so it can be reported (SEED command)
+void prngSeed(uint32_t seed);
+uint32_t prngSeedValue();
+
+// Seed from prngBootSeed, or from noise on A0 and the clock when that is 0
+void prngSeedBoot();
+
+static inline uint32_t prngNext() {
+    uint64_t old = prng.state;
+    prng.state = old * 6364136223846793005ULL + prng.inc;
+    uint32_t xorshifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+    uint32_t rot = (uint32_t)(old >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+}
+
+// Unbiased [0, n) from an already drawn word (Lemire's multiply-shift); the
+// rare rejection draws fresh words and is the only division
+uint32_t prngRangeFrom(uint32_t word, uint32_t n);
+
+static inline uint32_t prngRange(uint32_t n) {
+    return prngRangeFrom(prngNext(), n);
+}
+
+// Fill out[0..n) with consecutive words, for drawing a whole spawn at once
+void prngFill(uint32_t *out, int n);
+
+#endif // PRNG_H
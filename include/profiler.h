@@ -0,0 +1,55 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+// Per-stage frame timing from the DWT cycle counter. Every frame records one
+// sample per stage into a rolling window; statistics are only computed when
+// asked for (STATS command), so the loop pays a counter read and a store.
+
+enum ProfileStage : uint8_t {
+    PROF_CLIMAX,
+    PROF_FADE,
+    PROF_STARS,
+    PROF_COPY,
+    PROF_SHOW,
+    PROF_FRAME,     // whole frame from start to after show, excluding slack
+    PROF_STAGE_COUNT
+};
+
+// frames kept per stage, power of two
+#ifndef PROFILER_WINDOW
+#define PROFILER_WINDOW 128
+#endif
+
+struct ProfileSummary {
+    uint32_t samples;
+    uint32_t minCycles;
+    uint32_t avgCycles;
+    uint32_t maxCycles;
+    uint32_t p99Cycles;
+};
+
+void profilerInit();
+
+static inline uint32_t profilerNow() {
+    return ARM_DWT_CYCCNT;
+}
+
+// Record the cycles since `since` for stage and return the current count,
+// so consecutive stages can be chained
+uint32_t profilerLap(ProfileStage stage, uint32_t since);
+
+// Record PROF_FRAME and move the window on to the next frame
+void profilerEndFrame(uint32_t frameStart);
+
+void profilerSummary(ProfileStage stage, ProfileSummary &out);
+// Cycles the stage took in the most recently completed frame
+uint32_t profilerLastCycles(ProfileStage stage);
+void profilerReset();
+
+const char *profilerStageName(ProfileStage stage);
+bool profilerStageFromName(const char *name, ProfileStage &out);
+uint32_t profilerCyclesToUs(uint32_t cycles);
+
+#endif // PROFILER_H
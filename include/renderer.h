@@ -9,8 +9,42 @@
 void rendererInit();
 void rendererFree();
 void fadeBuffer();
+// Output stage: gamma + temporal dither from the 12.4 canvas into the LED bytes
 void copyBufferToOcto();
-void addPixelRGB_soft(int globalPixelIdx, float r, float g, float b);
+
+// The canvas is row-major over the whole wall; physical LED order is applied
+// only by copyBufferToOcto()
+static inline int canvasIndex(int x, int row) {
+    return row * TOTAL_WIDTH + x;
+}
+
+void addPixelRGB_soft(int canvasIdx, float r, float g, float b);
+// Same, with r/g/b already in canvas units (12.4: 16 = one 8-bit step)
+void addPixelCanvas(int canvasIdx, uint32_t r, uint32_t g, uint32_t b);
+
+// Power: estimated supply current of the canvas as drawn, the current after
+// the powerLimitMa scale of the last output pass, and that scale (0..1).
+// The idle draw is what the wall takes when black; a limit must exceed it.
+uint32_t rendererIdleMa();
+uint32_t rendererEstimatedMa();
+uint32_t rendererOutputMa();
+float rendererPowerScale();
+// Recompute the scale now (the output pass does this every frame)
+void rendererUpdatePower();
+
+// Dirty tracking: fade and copy only touch segments with content
+bool rendererIsBlank();
+// False when the canvas is black and the last shown frame was too
+bool rendererNeedsShow();
+// Call after octoShow() so the next frame can be skipped if nothing changed
+void rendererFrameShown();
+// Rewrite every LED on the next output pass, e.g. after the pixel map changed
+void rendererInvalidate();
+
+#ifdef RENDERER_PIXEL_COUNT
+// pixel writes (addPixelRGB_soft / addPixelCanvas) since last cleared (bench builds only)
+extern uint32_t rendererPixelWrites;
+#endif
 
 
 #endif // RENDERER_H
\ No newline at end of file
@@ -0,0 +1,86 @@
+#ifndef SERIAL_FRAMER_H
+#define SERIAL_FRAMER_H
+
+#include <Arduino.h>
+#include "../lib/CmdLib.h"
+#include "binary_protocol.h"
+
+// Longest "!!...##" frame accepted; anything longer is dropped
+#ifndef SERIAL_MAX_FRAME
+#define SERIAL_MAX_FRAME CMDLIB_BUF_SIZE
+#endif
+
+// Whole binary frame: magic, id, len, payload, CRC
+#define BIN_FRAME_MAX (BIN_MAX_PAYLOAD + 5)
+
+// Byte-level framing state machine for the "!!...##" text protocol and the
+// binary protocol (see binary_protocol.h), told apart by the first byte.
+// O(1) work per byte over a fixed buffer: hunt for "!!", collect until "##",
+// drop frames over SERIAL_MAX_FRAME and restart on a fresh "!!" mid-frame.
+//
+// A binary frame is only committed to once its id and length pass
+// binHeaderValid(). When the header is rejected or the CRC fails, the bytes
+// after the 0xB5 are scanned again, so a stray 0xB5 in line noise costs one
+// byte rather than hiding the frames behind it. Those bytes are queued
+// inside the framer: after each push(), call resume() while pending() to
+// get the results they produce.
+class SerialFramer {
+public:
+    enum Result {
+        NONE,       // byte consumed, no frame yet
+        FRAME,      // frame()/length() hold a complete frame until the next push()
+        TOO_LONG,   // frame exceeded SERIAL_MAX_FRAME and was dropped
+        BINARY,     // binaryId()/payload()/payloadLength() hold a binary frame
+        BAD_CRC     // binary frame with a valid header failed its CRC; binaryId() is its id
+    };
+
+    SerialFramer() : state(HUNT), len(0), binId(0), binLen(0), crc(0), rxCrc(0), pendingLen(0), pendingPos(0),
+                     discarded(0), overflows(0), resyncs(0), crcErrors(0), badHeaders(0) {}
+
+    Result push(uint8_t c);
+    // Bytes queued for another pass after a rejected binary frame
+    bool pending() const { return pendingPos < pendingLen; }
+    Result resume();
+    void reset() { state = HUNT; len = 0; pendingLen = pendingPos = 0; }
+
+    const char *frame() const { return buf; }
+    size_t length() const { return len; }
+
+    uint8_t binaryId() const { return binId; }
+    const uint8_t *payload() const { return (const uint8_t*)buf + 3; }
+    uint8_t payloadLength() const { return binLen; }
+
+    // Diagnostics
+    uint32_t discardedBytes() const { return discarded; }
+    uint32_t overflowCount() const { return overflows; }
+    uint32_t resyncCount() const { return resyncs; }
+    uint32_t crcErrorCount() const { return crcErrors; }
+    uint32_t badHeaderCount() const { return badHeaders; }
+
+private:
+    enum State { HUNT, START, BODY, BIN_ID, BIN_LEN, BIN_PAYLOAD, BIN_CRC_LO, BIN_CRC_HI };
+
+    static_assert(SERIAL_MAX_FRAME >= BIN_FRAME_MAX, "binary frame must fit the frame buffer");
+
+    Result step(uint8_t c);
+    void rescan();
+
+    // text frame, or a binary frame from its magic byte on
+    char buf[SERIAL_MAX_FRAME + 1];
+    State state;
+    uint16_t len;
+    uint8_t binId;
+    uint8_t binLen;
+    uint16_t crc;
+    uint16_t rxCrc;
+    uint8_t pendingBuf[BIN_FRAME_MAX];
+    uint16_t pendingLen;
+    uint16_t pendingPos;
+    uint32_t discarded;
+    uint32_t overflows;
+    uint32_t resyncs;
+    uint32_t crcErrors;
+    uint32_t badHeaders;
+};
+
+#endif // SERIAL_FRAMER_H
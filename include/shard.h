@@ -0,0 +1,60 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <Arduino.h>
+
+// Canvas sharding across several controllers. Node i draws global columns
+// [nodeColumnOffset, nodeColumnOffset + TOTAL_WIDTH) of a canvas globalWidth
+// columns wide. Nodes form a ring over ShardLinkSerial (TX of node i wired
+// to RX of node i+1, the last back to node 0) carrying binary frames:
+//
+//  - BIN_STAR_HANDOFF: a star approaching the right edge is sent on to the
+//    next node with its global x, and kept locally as a ghost until its
+//    trail has left, so it is drawn on both sides of the seam.
+//  - BIN_SYNC: node 0 sends its frame number, period and animation clock
+//    every frame; the others forward it and start their frame when it
+//    arrives, so all nodes step the same fixed dt in lockstep.
+//
+// Only the node drawing global column 0 spawns stars, so the wall has one
+// stream entering at its left edge that the handoff carries across. Effect
+// tracks and star TTLs run on shardClockMs(), which every node agrees on.
+//
+// With nodeCount == 1 none of this runs and the wall behaves as before.
+
+// star flags (StarStore::flags)
+#define STAR_FLAG_GHOST    0x01   // already handed to the next node
+#define STAR_FLAG_RESPAWN  0x02   // handoff only: receiver should respawn it
+
+void shardInit();
+
+// Apply a node layout at runtime; returns false if it doesn't make sense
+bool shardConfigure(uint8_t index, uint8_t count, int columnOffset, int width);
+bool shardEnabled();
+
+// Start of every frame: node 0 sends SYNC, others pick up the synced frame
+void shardBeginFrame();
+uint32_t shardFrame();
+// Animation clock in ms: advances one frame period per frame and follows
+// node 0 while sharded. Use it instead of millis() for anything that must
+// line up across nodes (tracks, TTLs).
+uint32_t shardClockMs();
+// Whether ADD_STAR spawns here (this node owns global column 0)
+bool shardSpawnsStars();
+// Fixed per-frame step used by every node while sharded
+float shardFrameDt();
+
+// Read the ring link; call from frame slack
+void shardPoll();
+
+// Send star i to the next node. It stays local (as a ghost) for the caller
+// to remove once its trail has left the canvas. On the last node a star on
+// its final pass (passes == 1) is only made a ghost and not sent round.
+void shardHandOff(int i);
+
+// Diagnostics
+uint32_t shardStarsSent();
+uint32_t shardStarsReceived();
+uint32_t shardSyncsReceived();
+uint32_t shardLinkErrors();
+
+#endif // SHARD_H
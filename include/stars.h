@@ -4,22 +4,74 @@
 #include <Arduino.h>
 #include "config.h"
 
-struct Star {
-    float x; // global continuous column position
-    int row; // row index 0..CURTAIN_HEIGHT-1
-    float vx; // columns per second
-    float bright; // 0..1
-    uint8_t r = 0, g = 0, b = 0;
-    int size;
+// Structure-of-arrays star store. Each field is its own MAX_STARS array and
+// live stars are kept packed in [0, activeStarCount): removal swaps the last
+// live star into the freed slot, so the slots past activeStarCount are the
+// free pool and spawning or despawning is O(1).
+struct StarStore {
+    float *x;        // global continuous column position
+    float *vx;       // columns per second
+    float *bright;   // 0..1
+    uint8_t *row;    // row index 0..CURTAIN_HEIGHT-1
+    uint8_t *r;
+    uint8_t *g;
+    uint8_t *b;
+    uint8_t *size;   // trail segments
+    uint8_t *flags;  // STAR_FLAG_* (shard.h)
+    uint8_t *passes; // crossings of the wall left before despawn, 0 = unlimited
+    uint8_t *group;  // 0..STAR_GROUPS-1: which starGroupMods entry applies
+    uint32_t *expires; // shardClockMs() at which the star despawns, 0 = never
 };
 
-extern Star *starsArr; // allocated to MAX_STARS
+extern StarStore stars; // arrays allocated to MAX_STARS
+
+// Modulators applied to stars as they are moved and drawn, so effects
+// (tween.h tracks) never rewrite or back up per-star fields. starMods covers
+// every star; starGroupMods[g] only the stars in group g, so a track bound to
+// a group's field gives those stars their own target. Per star the two
+// combine: the scales multiply, climb, wobble and phase add.
+#define STAR_GROUPS 4
+static_assert((STAR_GROUPS & (STAR_GROUPS - 1)) == 0, "STAR_GROUPS must be a power of two");
+
+struct StarModulators {
+    float speedScale;   // multiplies vx
+    float brightScale;  // multiplies bright
+    float climb;        // 0..1: drawn row moves from the star's row to row 0
+    float wobble;       // vertical sine wobble amplitude, rows
+    float wobblePhase;  // wobble phase in turns; the wave spans the canvas width once
+};
+
+extern StarModulators starMods;
+extern StarModulators starGroupMods[STAR_GROUPS];
+// Back to no effect, for starMods and every group
+void starsResetModulators();
 
 void starsInit();
 void starsFree();
-void randomizeStarProperties(Star &s, bool randomRowAllowed=true);
+void randomizeStarProperties(int i, bool randomRowAllowed=true);
 void updateAndRenderStars(float dt);
 
-bool addStar(float speed, int hexColor, int brightness, int size);
+// Spawn a star entering from the left; -1 for speed/colour/brightness/size/
+// group picks the default or a random value. passes/ttlMs of 0 mean it lives
+// until cleared. Returns false, changing nothing, when the store is full.
+bool addStar(float speed, int hexColor, int brightness, int size, uint8_t passes = 0, uint32_t ttlMs = 0,
+             int group = -1);
+// Spawn up to count stars like addStar, drawing their random properties in
+// batches; returns how many were added (fewer when the store fills up, none
+// on a sharded node that does not own global column 0)
+int starsSpawn(int count, float speed, int hexColor, int brightness, int size,
+               uint8_t passes = 0, uint32_t ttlMs = 0, int group = -1);
+// Add a star with every property given (group 0); returns its index or -1 when full
+int starsInsert(float x, float vx, float bright, uint8_t row, uint8_t r, uint8_t g, uint8_t b, uint8_t size);
+// Give star i a lifetime: passes across the wall and/or ms from now (0 = no limit)
+void starsSetLifetime(int i, uint8_t passes, uint32_t ttlMs);
+// ms until star i expires, 0 if it has no TTL
+uint32_t starsTimeLeft(int i);
+// Stars despawned by running out of passes or TTL since boot
+unsigned long starsExpired();
+// Count a star despawned outside the star loop (a last pass leaving the ring)
+void starsCountExpired();
+void starsRemove(int i);
+void starsClear();
 
-#endif // STARS_H
\ No newline at end of file
+#endif // STARS_H
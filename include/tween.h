@@ -0,0 +1,42 @@
+#ifndef TWEEN_H
+#define TWEEN_H
+
+#include <Arduino.h>
+#include "easing.h"
+
+// Keyframe animation of float parameters. A track drives one float (a global
+// such as fadeFactor, a field of starMods, or of starGroupMods[g] to reach
+// only the stars in group g) through up to TWEEN_MAX_KEYS
+// keyframes over a duration, easing between them. Tracks live in a fixed
+// pool and cost one segment evaluation each per frame, however many stars
+// they affect. Effects are built by starting a few tracks, e.g. the climax
+// buildup and spiral in climax_command_handler.cpp.
+
+#define TWEEN_MAX_TRACKS 8
+#define TWEEN_MAX_KEYS 4
+
+struct TweenKey {
+    float at;       // 0..1 of the track's duration, increasing
+    float value;
+    uint8_t ease;   // EaseCurve used to reach this key from the previous one
+};
+
+// Called once when a track reaches its last key (not when it is stopped)
+typedef void (*TweenDone)();
+
+// Start (or restart) the track called name; it begins at keys[0].value and
+// holds the last key's value once done. Returns the track slot or -1 if the
+// pool is full or the keys are invalid.
+int tweenStart(const char *name, float *target, const TweenKey *keys, uint8_t keyCount,
+               unsigned long durationMs, TweenDone onDone = nullptr);
+
+// Stop a running track where it is, without calling its onDone
+bool tweenStop(const char *name);
+
+int tweenActiveCount();
+
+// Advance every track to nowMs (shardClockMs(), so tracks line up across
+// sharded nodes); call once per frame
+void tweenUpdate(unsigned long nowMs);
+
+#endif // TWEEN_H
@@ -8,6 +8,12 @@
 
 #ifdef CMDLIB_ARDUINO
   #include <WString.h>
+  #include <Print.h>
+  #include <stdint.h>
+  #include <stdio.h>
+  #include <stdlib.h>
+  #include <string.h>
+  #include <ctype.h>
 #else
   #include <string>
   #include <vector>
@@ -20,87 +26,231 @@ namespace cmdlib {
 
 #ifdef CMDLIB_ARDUINO
 // -------------------- Arduino Version (named-only params) --------------------
+// Allocation-free: a Command owns one fixed char buffer. parse() copies the
+// frame into it once and tokenizes in place; every header, key and value is a
+// NUL-terminated span inside that buffer. Building a response appends into
+// the same buffer, so nothing here touches the heap (except toString()).
 #ifndef CMDLIB_MAX_PARAMS
-#define CMDLIB_MAX_PARAMS 12
+#define CMDLIB_MAX_PARAMS 20
 #endif
 #ifndef CMDLIB_MAX_HEADER_PARTS
 #define CMDLIB_MAX_HEADER_PARTS 8
 #endif
+#ifndef CMDLIB_BUF_SIZE
+#define CMDLIB_BUF_SIZE 384
+#endif
+
+// Span inside Command::buf (len == 0 reads as "")
+struct Token {
+  uint16_t off;
+  uint16_t len;
+};
 
 struct NamedParam {
-  String key;
-  String value;
+  Token key;
+  Token value;
 };
 
+// Number helpers over C strings; none of them allocate
+static inline long parseIntStr(const char *s) {
+  return strtol(s, nullptr, 10);
+}
+
+static inline long parseHexStr(const char *s) {
+  while (isspace((unsigned char)*s)) s++;
+  if (s[0] == '#') s++;
+  else if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) s += 2;
+  return (long)strtoul(s, nullptr, 16);
+}
+
+static inline float parseFloatStr(const char *s) {
+  while (isspace((unsigned char)*s)) s++;
+  bool neg = false;
+  if (*s == '-' || *s == '+') neg = (*s++ == '-');
+  float v = 0.0f;
+  while (*s >= '0' && *s <= '9') v = v * 10.0f + (float)(*s++ - '0');
+  if (*s == '.') {
+    s++;
+    float scale = 0.1f;
+    while (*s >= '0' && *s <= '9') { v += (float)(*s++ - '0') * scale; scale *= 0.1f; }
+  }
+  if (*s == 'e' || *s == 'E') {
+    s++;
+    bool expNeg = false;
+    if (*s == '-' || *s == '+') expNeg = (*s++ == '-');
+    int e = 0;
+    while (*s >= '0' && *s <= '9' && e < 64) e = e * 10 + (*s++ - '0');
+    while (e-- > 0) v = expNeg ? v * 0.1f : v * 10.0f;
+  }
+  return neg ? -v : v;
+}
+
+// Fixed-point float formatting into out (>= 24 bytes)
+static inline void formatFloatStr(char *out, float v, int decimals) {
+  if (decimals < 0) decimals = 0;
+  if (decimals > 6) decimals = 6;
+  long scale = 1;
+  for (int i = 0; i < decimals; i++) scale *= 10;
+  bool neg = v < 0.0f;
+  if (neg) v = -v;
+  if (v > 2.0e9f / (float)scale) v = 2.0e9f / (float)scale;
+  unsigned long fixed = (unsigned long)(v * (float)scale + 0.5f);
+  unsigned long whole = fixed / (unsigned long)scale;
+  unsigned long frac = fixed % (unsigned long)scale;
+  if (decimals == 0) snprintf(out, 24, "%s%lu", neg ? "-" : "", whole);
+  else snprintf(out, 24, "%s%lu.%0*lu", neg ? "-" : "", whole, decimals, frac);
+}
+
 struct Command {
+  char buf[CMDLIB_BUF_SIZE];
+  uint16_t used = 0;
+
   // Leading header parts (source, destination, etc.), e.g. "MASTER", "[ARM#]"
-  String headers[CMDLIB_MAX_HEADER_PARTS];
+  Token headers[CMDLIB_MAX_HEADER_PARTS];
   int headerCount = 0;
 
   // The message kind and the command name
-  String msgKind;
-  String command;
+  Token msgKindTok = {0, 0};
+  Token commandTok = {0, 0};
 
   // Named params only
   NamedParam namedParams[CMDLIB_MAX_PARAMS];
   int namedCount = 0;
 
+  // A header, param or value did not fit (CMDLIB_MAX_* or CMDLIB_BUF_SIZE)
+  // and was dropped; senders check this rather than every set call
+  bool overflowed = false;
+
   void clear() {
+    used = 0;
+    overflowed = false;
     headerCount = 0;
-    msgKind = "";
-    command = "";
     namedCount = 0;
-    for (int i = 0; i < CMDLIB_MAX_PARAMS; ++i) {
-      if (i < CMDLIB_MAX_HEADER_PARTS) headers[i] = "";
-      namedParams[i].key = ""; namedParams[i].value = "";
-    }
+    msgKindTok = {0, 0};
+    commandTok = {0, 0};
+  }
+
+  const char *str(const Token &t) const { return t.len ? buf + t.off : ""; }
+
+  // Copy s[0..len) plus a NUL into the buffer
+  bool store(const char *s, size_t len, Token &out) {
+    if (len == 0) { out = {0, 0}; return true; }
+    if ((size_t)used + len + 1 > CMDLIB_BUF_SIZE) { overflowed = true; return false; }
+    memcpy(buf + used, s, len);
+    buf[used + len] = '\0';
+    out.off = used;
+    out.len = (uint16_t)len;
+    used = (uint16_t)(used + len + 1);
+    return true;
   }
 
+  // message kind / command
+  const char *msgKind() const { return str(msgKindTok); }
+  const char *command() const { return str(commandTok); }
+  bool isMsgKind(const char *k) const { return strcmp(msgKind(), k) == 0; }
+  bool isCommand(const char *c) const { return strcmp(command(), c) == 0; }
+  bool setMsgKind(const char *k) { return store(k, strlen(k), msgKindTok); }
+  bool setCommand(const char *c) { return store(c, strlen(c), commandTok); }
+
   // header helpers
-  bool addHeader(const String &h) {
-    if (headerCount >= CMDLIB_MAX_HEADER_PARTS) return false;
-    headers[headerCount++] = h;
+  bool addHeader(const char *h) {
+    if (headerCount >= CMDLIB_MAX_HEADER_PARTS) { overflowed = true; return false; }
+    if (!store(h, strlen(h), headers[headerCount])) return false;
+    headerCount++;
     return true;
   }
-  String getHeader(int i) const { if (i < 0 || i >= headerCount) return ""; return headers[i]; }
+  const char *getHeader(int i) const { if (i < 0 || i >= headerCount) return ""; return str(headers[i]); }
 
   // named param helpers
-  bool setNamed(const String &k, const String &v) {
-    for (int i = 0; i < namedCount; ++i) {
-      if (namedParams[i].key == k) { namedParams[i].value = v; return true; }
-    }
-    if (namedCount >= CMDLIB_MAX_PARAMS) return false;
-    namedParams[namedCount].key = k;
-    namedParams[namedCount].value = v;
+  int findNamed(const char *k) const {
+    for (int i = 0; i < namedCount; ++i) if (strcmp(str(namedParams[i].key), k) == 0) return i;
+    return -1;
+  }
+  bool hasNamed(const char *k) const { return findNamed(k) >= 0; }
+  bool setNamed(const char *k, const char *v) {
+    int i = findNamed(k);
+    if (i >= 0) return store(v, strlen(v), namedParams[i].value);
+    if (namedCount >= CMDLIB_MAX_PARAMS) { overflowed = true; return false; }
+    NamedParam &p = namedParams[namedCount];
+    if (!store(k, strlen(k), p.key) || !store(v, strlen(v), p.value)) return false;
     namedCount++;
     return true;
   }
-  String getNamed(const String &k, const String &def = "") const {
-    for (int i = 0; i < namedCount; ++i) if (namedParams[i].key == k) return namedParams[i].value;
-    return def;
+  bool setNamed(const char *k, long v) { char tmp[24]; snprintf(tmp, sizeof(tmp), "%ld", v); return setNamed(k, tmp); }
+  bool setNamed(const char *k, unsigned long v) { char tmp[24]; snprintf(tmp, sizeof(tmp), "%lu", v); return setNamed(k, tmp); }
+  bool setNamed(const char *k, int v) { return setNamed(k, (long)v); }
+  bool setNamed(const char *k, unsigned int v) { return setNamed(k, (unsigned long)v); }
+  bool setNamed(const char *k, double v, int decimals) { char tmp[24]; formatFloatStr(tmp, (float)v, decimals); return setNamed(k, tmp); }
+
+  const char *getNamed(const char *k, const char *def = "") const {
+    int i = findNamed(k);
+    return i >= 0 ? str(namedParams[i].value) : def;
+  }
+  long getInt(const char *k, long def) const {
+    int i = findNamed(k);
+    return i >= 0 ? parseIntStr(str(namedParams[i].value)) : def;
+  }
+  float getFloat(const char *k, float def) const {
+    int i = findNamed(k);
+    return i >= 0 ? parseFloatStr(str(namedParams[i].value)) : def;
   }
+  // Hex with optional "0x" / "#" prefix
+  long getHex(const char *k, long def) const {
+    int i = findNamed(k);
+    return i >= 0 ? parseHexStr(str(namedParams[i].value)) : def;
+  }
+
+  // Write the wire form straight to a Print (Serial etc.) without building a String
+  size_t printTo(Print &out) const {
+    size_t n = out.write("!!");
+    for (int i = 0; i < headerCount; ++i) {
+      if (i) n += out.write(":");
+      n += out.write(getHeader(i));
+    }
+    if (msgKindTok.len > 0) {
+      if (headerCount) n += out.write(":");
+      n += out.write(msgKind());
+    }
+    if (commandTok.len > 0) {
+      n += out.write(":");
+      n += out.write(command());
+    }
+    if (namedCount > 0) {
+      n += out.write("{");
+      for (int i = 0; i < namedCount; ++i) {
+        n += out.write(str(namedParams[i].key));
+        n += out.write("=");
+        n += out.write(str(namedParams[i].value));
+        if (i < namedCount - 1) n += out.write(",");
+      }
+      n += out.write("}");
+    }
+    n += out.write("##");
+    return n;
+  }
+  size_t printlnTo(Print &out) const { size_t n = printTo(out); return n + out.println(); }
 
-  // Build string using named params (if any)
+  // Build string using named params (if any); allocates, prefer printTo()
   String toString() const {
     String out = "!!";
     for (int i = 0; i < headerCount; ++i) {
       if (i) out += ":";
-      out += headers[i];
+      out += getHeader(i);
     }
-    if (msgKind.length() > 0) {
+    if (msgKindTok.len > 0) {
       if (headerCount) out += ":";
-      out += msgKind;
+      out += msgKind();
     }
-    if (command.length() > 0) {
+    if (commandTok.len > 0) {
       out += ":";
-      out += command;
+      out += command();
     }
     if (namedCount > 0) {
       out += "{";
       for (int i = 0; i < namedCount; ++i) {
-        out += namedParams[i].key;
+        out += str(namedParams[i].key);
         out += "=";
-        out += namedParams[i].value;
+        out += str(namedParams[i].value);
         if (i < namedCount - 1) out += ",";
       }
       out += "}";
@@ -110,83 +260,113 @@ struct Command {
   }
 };
 
-// Utility: trim spaces
-static inline String trimStr(const String &s) {
-  int start = 0;
-  while (start < s.length() && isspace(s.charAt(start))) start++;
-  int end = s.length() - 1;
-  while (end >= start && isspace(s.charAt(end))) end--;
-  if (end < start) return "";
-  return s.substring(start, end + 1);
+// Trim [a, b) in place: returns the trimmed token, NUL-terminating it in buf
+static inline Token trimToken(char *buf, int a, int b) {
+  while (a < b && isspace((unsigned char)buf[a])) a++;
+  while (b > a && isspace((unsigned char)buf[b - 1])) b--;
+  buf[b] = '\0';
+  Token t;
+  t.off = (uint16_t)a;
+  t.len = (uint16_t)(b - a);
+  return t;
 }
 
-// Parse function for Arduino String (named-only)
-static inline bool parse(const String &input, Command &out, String &error) {
+// Parse one frame (named-only) without allocating; error points at a literal
+static inline bool parse(const char *input, size_t len, Command &out, const char *&error) {
   out.clear();
   error = "";
 
-  if (!input.startsWith("!!")) { error = "Missing prefix '!!'"; return false; }
-  if (!input.endsWith("##")) { error = "Missing suffix '##'"; return false; }
+  if (len < 2 || input[0] != '!' || input[1] != '!') { error = "Missing prefix '!!'"; return false; }
+  if (len < 4 || input[len - 2] != '#' || input[len - 1] != '#') { error = "Missing suffix '##'"; return false; }
+  if (len + 1 > CMDLIB_BUF_SIZE) { error = "Command too long"; return false; }
 
-  int braceOpen = input.indexOf('{');
-  int braceClose = input.lastIndexOf('}');
+  // Own copy of the frame; tokens are carved out of it in place
+  char *buf = out.buf;
+  memcpy(buf, input, len);
+  buf[len] = '\0';
+  out.used = (uint16_t)(len + 1);
+
+  int end = (int)len - 2; // index of the "##" suffix
+  int braceOpen = -1, braceClose = -1;
+  for (int i = 2; i < end; ++i) if (buf[i] == '{') { braceOpen = i; break; }
+  for (int i = end - 1; i >= 2; --i) if (buf[i] == '}') { braceClose = i; break; }
 
   if (braceOpen == -1 && braceClose != -1) {
     error = "Malformed braces";
     return false;
   }
+  if (braceOpen != -1 && (braceClose == -1 || braceClose < braceOpen)) {
+    error = "Malformed braces";
+    return false;
+  }
 
-  int headerEnd = (braceOpen != -1) ? braceOpen : input.lastIndexOf("##");
-  if (headerEnd == -1) { error = "Malformed header"; return false; }
-  String header = input.substring(2, headerEnd);
-  if (header.endsWith(":")) header = header.substring(0, header.length() - 1);
-
-  int start = 0;
-  while (start < header.length()) {
-    int idx = header.indexOf(':', start);
-    String token;
-    if (idx == -1) { token = trimStr(header.substring(start)); start = header.length(); }
-    else { token = trimStr(header.substring(start, idx)); start = idx + 1; }
-    if (token.length() > 0) {
-      if (!out.addHeader(token)) { error = "Too many header parts"; return false; }
+  int headerEnd = (braceOpen != -1) ? braceOpen : end;
+  if (headerEnd > 2 && buf[headerEnd - 1] == ':') headerEnd--;
+
+  int start = 2;
+  while (start < headerEnd) {
+    int idx = start;
+    while (idx < headerEnd && buf[idx] != ':') idx++;
+    Token token = trimToken(buf, start, idx);
+    start = idx + 1;
+    if (token.len > 0) {
+      if (out.headerCount >= CMDLIB_MAX_HEADER_PARTS) { error = "Too many header parts"; return false; }
+      out.headers[out.headerCount++] = token;
     }
   }
 
   if (out.headerCount == 0) { error = "Empty header"; return false; }
   if (out.headerCount == 1) { error = "Incomplete header"; return false; }
 
-  out.command = out.headers[out.headerCount - 1];
-  out.msgKind = out.headers[out.headerCount - 2];
+  out.commandTok = out.headers[out.headerCount - 1];
+  out.msgKindTok = out.headers[out.headerCount - 2];
   out.headerCount -= 2;
 
   if (braceOpen != -1) {
-    if (braceClose == -1 || braceClose < braceOpen) { error = "Malformed braces"; return false; }
-    String inside = input.substring(braceOpen + 1, braceClose);
-    int i = 0;
-    while (i < inside.length()) {
-      while (i < inside.length() && isspace(inside.charAt(i))) i++;
-      if (i >= inside.length()) break;
+    int i = braceOpen + 1;
+    while (i < braceClose) {
       int startKey = i;
-      while (i < inside.length() && inside.charAt(i) != ',') i++;
-      String token = trimStr(inside.substring(startKey, i));
-      if (token.length() > 0) {
-        int eq = token.indexOf('=');
-        if (eq == -1) {
-          // key only, empty value
-          out.setNamed(token, "");
-        } else {
-          String key = trimStr(token.substring(0, eq));
-          String val = trimStr(token.substring(eq + 1));
-          out.setNamed(key, val);
-        }
+      while (i < braceClose && buf[i] != ',') i++;
+      int tokenEnd = i;
+      i++; // past ','
+
+      int eq = startKey;
+      while (eq < tokenEnd && buf[eq] != '=') eq++;
+
+      Token key, value = {0, 0};
+      if (eq == tokenEnd) {
+        // key only, empty value
+        key = trimToken(buf, startKey, tokenEnd);
+      } else {
+        key = trimToken(buf, startKey, eq);
+        value = trimToken(buf, eq + 1, tokenEnd);
+      }
+      if (key.len == 0) continue;
+
+      int existing = out.findNamed(out.str(key));
+      if (existing >= 0) {
+        out.namedParams[existing].value = value;
+      } else if (out.namedCount < CMDLIB_MAX_PARAMS) {
+        out.namedParams[out.namedCount].key = key;
+        out.namedParams[out.namedCount].value = value;
+        out.namedCount++;
+      } else {
+        out.overflowed = true;
       }
-      if (i < inside.length() && inside.charAt(i) == ',') i++;
     }
   }
 
   return true;
 }
 
+// Convenience overload for String callers (allocates only for the error text)
+static inline bool parse(const String &input, Command &out, String &error) {
+  const char *err = "";
+  bool ok = parse(input.c_str(), input.length(), out, err);
+  error = err;
+  return ok;
+}
+
 #else
 // -------------------- Standard C++ Version (named-only params) --------------------
 using std::string;
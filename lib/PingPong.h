@@ -48,20 +48,25 @@ public:
     if (!initialized) return;
     
     // Check if this is a PING request
-    if (cmd.msgKind == "REQUEST" && cmd.command == "PING") {
-      lastPingTime = millis();
-      PING_IDLE = false;
+    if (cmd.isMsgKind("REQUEST") && cmd.isCommand("PING")) {
+      notePing();
       
       cmdlib::Command response;
       // Send's back to who requested the PING
       response.addHeader(cmd.getHeader(0));
-      response.msgKind = "CONFIRM";
-      response.command = "PING";
+      response.setMsgKind("CONFIRM");
+      response.setCommand("PING");
       
-      serialPort->println(response.toString());
+      response.printlnTo(*serialPort);
     }
   }
   
+  // Record a ping that arrived without a text reply (e.g. binary protocol)
+  void notePing() {
+    lastPingTime = millis();
+    PING_IDLE = false;
+  }
+  
   // Update the idle status (call this regularly)
   void update() {
     if (!initialized) return;
@@ -80,15 +85,15 @@ public:
   }
   
   // Force a ping response to a specific recipient
-  void sendPing(const String& to) {
+  void sendPing(const char* to) {
     if (!initialized) return;
     
     cmdlib::Command ping;
     ping.addHeader(to);      // TO
-    ping.msgKind = "REQUEST";
-    ping.command = "PING";
+    ping.setMsgKind("REQUEST");
+    ping.setCommand("PING");
     
-    serialPort->println(ping.toString());
+    ping.printlnTo(*serialPort);
   }
   
   // Get the current serial port
@@ -0,0 +1,153 @@
+// Render pipeline microbenchmarks for [env:bench]. Drives fadeBuffer(),
+// updateAndRenderStars(), copyBufferToOcto() and addPixelRGB_soft() under
+// fixed star loads and prints one JSON document to stdout, so results can be
+// diffed across commits. A readable table goes to stderr.
+//
+//   program [-f frames] [-w warmup]
+#include <Arduino.h>
+#include <unistd.h>
+#include <chrono>
+#include "config.h"
+#include "renderer.h"
+#include "mapping.h"
+#include "stars.h"
+#include "prng.h"
+#include "octo_wrapper.h"
+
+#ifndef RENDERER_PIXEL_COUNT
+#error "bench needs -DRENDERER_PIXEL_COUNT"
+#endif
+
+static const int starCounts[] = { 0, 100, 500, 5000 };
+static const int trailSizes[] = { 1, 2, 5, 10, 20 };
+static const float frameDt = 1.0f / 60.0f;
+
+struct CaseResult {
+    double fadeNs;
+    double starsNs;
+    double copyNs;
+    double frameNs;
+    double pixelsPerFrame;
+};
+
+static inline uint64_t nowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void resetScene(int count, int size, bool wrap) {
+    prngSeed(12345);
+    wrapStars = wrap;
+    starsClear();
+    for (int i = 0; i < count; i++) {
+        addStar(-1, -1, -1, size);
+        // spread the field over the whole width so the load is steady from frame 0
+        stars.x[i] = prngRange(TOTAL_WIDTH * 100) / 100.0f;
+    }
+    // start from a dark canvas
+    for (int i = 0; i < 64; i++) fadeBuffer();
+}
+
+static CaseResult runCase(int count, int size, bool wrap, int frames, int warmup) {
+    resetScene(count, size, wrap);
+    for (int i = 0; i < warmup; i++) {
+        fadeBuffer();
+        updateAndRenderStars(frameDt);
+        copyBufferToOcto();
+    }
+
+    uint64_t fadeNs = 0, starsNs = 0, copyNs = 0;
+    rendererPixelWrites = 0;
+    for (int i = 0; i < frames; i++) {
+        uint64_t t0 = nowNs();
+        fadeBuffer();
+        uint64_t t1 = nowNs();
+        updateAndRenderStars(frameDt);
+        uint64_t t2 = nowNs();
+        copyBufferToOcto();
+        uint64_t t3 = nowNs();
+        fadeNs += t1 - t0;
+        starsNs += t2 - t1;
+        copyNs += t3 - t2;
+    }
+
+    CaseResult r;
+    r.fadeNs = (double)fadeNs / frames;
+    r.starsNs = (double)starsNs / frames;
+    r.copyNs = (double)copyNs / frames;
+    r.frameNs = r.fadeNs + r.starsNs + r.copyNs;
+    r.pixelsPerFrame = (double)rendererPixelWrites / frames;
+    return r;
+}
+
+// addPixelRGB_soft() on its own: a sweep over every pixel, ns per call
+static double benchAddPixel(int passes) {
+    for (int i = 0; i < 64; i++) fadeBuffer();
+    uint64_t t0 = nowNs();
+    for (int p = 0; p < passes; p++) {
+        for (int i = 0; i < NUM_PIXELS; i++) {
+            addPixelRGB_soft(i, 3.5f, 1.25f, 0.5f);
+        }
+        fadeBuffer();
+    }
+    uint64_t t1 = nowNs();
+    // subtract the fades so only the writes are counted
+    uint64_t t2 = nowNs();
+    for (int p = 0; p < passes; p++) fadeBuffer();
+    uint64_t t3 = nowNs();
+    double writeNs = (double)(t1 - t0) - (double)(t3 - t2);
+    return writeNs / ((double)passes * NUM_PIXELS);
+}
+
+int main(int argc, char **argv) {
+    int frames = 300;
+    int warmup = 30;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:w:h")) != -1) {
+        switch (opt) {
+            case 'f': frames = atoi(optarg); break;
+            case 'w': warmup = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-f frames] [-w warmup]\n", argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (frames < 1) frames = 1;
+
+    mappingBuild();
+    rendererInit();
+    starsInit();
+    octoBegin();
+
+    printf("{\n  \"config\": {\"width\": %d, \"height\": %d, \"pixels\": %d, \"maxStars\": %d, \"frames\": %d, \"fadeFactor\": %.3f},\n",
+           TOTAL_WIDTH, TOTAL_HEIGHT, NUM_PIXELS, MAX_STARS, frames, fadeFactor);
+    printf("  \"addPixelNs\": %.2f,\n", benchAddPixel(frames));
+    printf("  \"cases\": [\n");
+
+    fprintf(stderr, "%6s %4s %4s %10s %10s %10s %10s %10s\n",
+            "stars", "size", "wrap", "fade_ns", "stars_ns", "copy_ns", "frame_ns", "pixels");
+
+    bool first = true;
+    for (int count : starCounts) {
+        for (int size : trailSizes) {
+            if (count == 0 && size != 1) continue;   // trail size is moot with no stars
+            for (int wrap = 0; wrap < 2; wrap++) {
+                printf("%s    {\"stars\": %d, \"size\": %d, \"wrap\": %s, ", first ? "" : ",\n",
+                       count, size, wrap ? "true" : "false");
+                first = false;
+                if (count > MAX_STARS) {
+                    printf("\"skipped\": \"MAX_STARS is %d\"}", MAX_STARS);
+                    fprintf(stderr, "%6d %4d %4d   skipped (MAX_STARS %d)\n", count, size, wrap, MAX_STARS);
+                    continue;
+                }
+                CaseResult r = runCase(count, size, wrap != 0, frames, warmup);
+                printf("\"fadeNs\": %.0f, \"starsNs\": %.0f, \"copyNs\": %.0f, \"frameNs\": %.0f, \"pixelsPerFrame\": %.1f}",
+                       r.fadeNs, r.starsNs, r.copyNs, r.frameNs, r.pixelsPerFrame);
+                fprintf(stderr, "%6d %4d %4d %10.0f %10.0f %10.0f %10.0f %10.1f\n",
+                        count, size, wrap, r.fadeNs, r.starsNs, r.copyNs, r.frameNs, r.pixelsPerFrame);
+            }
+        }
+    }
+    printf("\n  ]\n}\n");
+    return 0;
+}
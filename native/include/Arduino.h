@@ -0,0 +1,45 @@
+// Host stand-in for the Teensy Arduino core (native env only)
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+
+#ifndef ARDUINO
+#define ARDUINO 10819
+#endif
+
+typedef uint8_t byte;
+
+#define DMAMEM
+#define FASTRUN
+#define A0 14
+#define F_CPU_ACTUAL 1000000000UL
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+int analogRead(uint8_t pin);
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+char *dtostrf(double val, int width, unsigned int precision, char *buf);
+
+// Cycle counter stand-in: one "cycle" per nanosecond of host steady clock
+uint32_t hostCycleCount();
+#define ARM_DWT_CYCCNT (hostCycleCount())
+
+template <class A, class B> inline auto min(A a, B b) -> decltype(a < b ? a : b) { return a < b ? a : b; }
+template <class A, class B> inline auto max(A a, B b) -> decltype(a > b ? a : b) { return a > b ? a : b; }
+template <class T, class L, class H> inline T constrain(T v, L lo, H hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+#endif // HOST_ARDUINO_H
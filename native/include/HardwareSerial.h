@@ -0,0 +1,37 @@
+// Host stand-in for Teensy serial ports, backed by file descriptors
+#ifndef HOST_HARDWARE_SERIAL_H
+#define HOST_HARDWARE_SERIAL_H
+
+#include "Stream.h"
+
+class HardwareSerial : public Stream {
+public:
+    explicit HardwareSerial(int outFd) : inFd(-1), outFd(outFd), peeked(-1) {}
+
+    void begin(unsigned long) {}
+    void end() {}
+    operator bool() const { return true; }
+
+    // Attach host file descriptors (-1 disables that direction)
+    void attach(int in, int out) { inFd = in; outFd = out; }
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t len) override;
+    using Print::write;
+    int availableForWrite() override { return 4096; }
+    void flush() {}
+
+private:
+    int inFd;
+    int outFd;
+    int peeked;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+
+#endif // HOST_HARDWARE_SERIAL_H
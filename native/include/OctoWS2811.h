@@ -0,0 +1,59 @@
+// Host stand-in for OctoWS2811: keeps the Teensy 4.x drawing-buffer layout
+// (3 bytes per LED, strips back to back) and hands finished frames to a hook.
+#ifndef HOST_OCTOWS2811_H
+#define HOST_OCTOWS2811_H
+
+#include <stdint.h>
+#include <string.h>
+
+// same linear drawing-buffer layout as the Teensy 4.x driver
+#define OCTOWS2811_LINEAR_DRAWBUFFER 1
+
+#define WS2811_RGB 0
+#define WS2811_RBG 1
+#define WS2811_GRB 2
+#define WS2811_GBR 3
+#define WS2811_BRG 4
+#define WS2811_BGR 5
+#define WS2811_800kHz 0x00
+#define WS2811_400kHz 0x10
+
+class OctoWS2811 {
+public:
+    typedef void (*ShowHook)(const uint8_t *frame, uint32_t numBytes);
+
+    OctoWS2811(uint32_t numPerStrip, void *frameBuf, void *drawBuf, uint8_t config,
+               uint8_t numPins = 8, const uint8_t *pinList = nullptr)
+        : stripLen(numPerStrip), frameBuffer((uint8_t *)frameBuf), drawBuffer((uint8_t *)drawBuf),
+          params(config), pins(numPins) { (void)pinList; }
+
+    void begin() {}
+    void show() {
+        memcpy(frameBuffer, drawBuffer, numPixels() * 3);
+        shows++;
+        if (hook) hook(frameBuffer, numPixels() * 3);
+    }
+    int busy() { return 0; }
+    void setPixel(uint32_t num, int color) { setPixel(num, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF); }
+    void setPixel(uint32_t num, uint8_t r, uint8_t g, uint8_t b) {
+        uint8_t *dest = drawBuffer + num * 3;
+        dest[0] = r; dest[1] = g; dest[2] = b;
+    }
+    int getPixel(uint32_t num) {
+        const uint8_t *p = drawBuffer + num * 3;
+        return (p[0] << 16) | (p[1] << 8) | p[2];
+    }
+    int numPixels() { return stripLen * pins; }
+
+    static ShowHook hook;
+    static uint32_t shows;
+
+private:
+    uint32_t stripLen;
+    uint8_t *frameBuffer;
+    uint8_t *drawBuffer;
+    uint8_t params;
+    uint8_t pins;
+};
+
+#endif // HOST_OCTOWS2811_H
@@ -0,0 +1,41 @@
+// Host stand-in for Arduino Print
+#ifndef HOST_PRINT_H
+#define HOST_PRINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "WString.h"
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t *buf, size_t len) {
+        size_t n = 0;
+        while (len--) n += write(*buf++);
+        return n;
+    }
+    virtual int availableForWrite() { return 0; }
+    size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+    size_t write(const char *s, size_t len) { return write((const uint8_t *)s, len); }
+
+    size_t print(const char *s) { return write(s); }
+    size_t print(const String &s) { return write(s.c_str(), s.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v) { return printNumber((long)v); }
+    size_t print(long v) { return printNumber(v); }
+    size_t print(unsigned int v) { return printUnsigned(v); }
+    size_t print(unsigned long v) { return printUnsigned(v); }
+    size_t print(double v, int digits = 2);
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(const T &v) { size_t n = print(v); return n + println(); }
+    size_t println(double v, int digits) { size_t n = print(v, digits); return n + println(); }
+
+private:
+    size_t printNumber(long v);
+    size_t printUnsigned(unsigned long v);
+};
+
+#endif // HOST_PRINT_H
@@ -0,0 +1,75 @@
+#include <Arduino.h>
+#include <OctoWS2811.h>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+static const auto hostStart = std::chrono::steady_clock::now();
+
+unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - hostStart).count();
+}
+unsigned long millis() { return micros() / 1000UL; }
+uint32_t hostCycleCount() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - hostStart).count();
+}
+void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+void delayMicroseconds(unsigned int us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+void yield() {}
+int analogRead(uint8_t) { return 0; }
+
+static uint32_t hostRandState = 1;
+void randomSeed(unsigned long seed) { if (seed) hostRandState = (uint32_t)seed; }
+static uint32_t hostRand() {
+    hostRandState ^= hostRandState << 13; hostRandState ^= hostRandState >> 17; hostRandState ^= hostRandState << 5;
+    return hostRandState;
+}
+long random(long howbig) { return howbig <= 0 ? 0 : (long)(hostRand() % (uint32_t)howbig); }
+long random(long howsmall, long howbig) { return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall); }
+
+char *dtostrf(double val, int width, unsigned int precision, char *buf) {
+    sprintf(buf, "%*.*f", width, (int)precision, val);
+    return buf;
+}
+
+size_t Print::print(double v, int digits) {
+    char b[48];
+    snprintf(b, sizeof(b), "%.*f", digits, v);
+    return write(b);
+}
+size_t Print::printNumber(long v) { char b[24]; snprintf(b, sizeof(b), "%ld", v); return write(b); }
+size_t Print::printUnsigned(unsigned long v) { char b[24]; snprintf(b, sizeof(b), "%lu", v); return write(b); }
+
+int HardwareSerial::available() {
+    if (peeked >= 0) return 1;
+    peeked = read();
+    return peeked >= 0 ? 1 : 0;
+}
+int HardwareSerial::read() {
+    if (peeked >= 0) { int c = peeked; peeked = -1; return c; }
+    if (inFd < 0) return -1;
+    uint8_t c;
+    ssize_t n = ::read(inFd, &c, 1);
+    return n == 1 ? c : -1;
+}
+int HardwareSerial::peek() { available(); return peeked; }
+size_t HardwareSerial::write(const uint8_t *buf, size_t len) {
+    if (outFd < 0) return len;
+    ssize_t n = ::write(outFd, buf, len);
+    return n < 0 ? 0 : (size_t)n;
+}
+
+HardwareSerial Serial(2);
+HardwareSerial Serial1(1);
+HardwareSerial Serial2(-1);
+
+OctoWS2811::ShowHook OctoWS2811::hook = nullptr;
+uint32_t OctoWS2811::shows = 0;
+
+// heap markers read by freeMemory()
+char *__brkval = nullptr;
+char __bss_end;
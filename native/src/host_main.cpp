@@ -0,0 +1,206 @@
+// Headless entry point for the native env: runs the firmware's setup()/loop()
+// on the host, replaying command bytes into the command port.
+//
+//   program [-r replay] [-n frames] [-o frames.rgb] [-t timings.csv] [-I link_in -O link_out]
+//
+// -r  file (or fifo) whose bytes arrive on CommunicationSerial; responses go to stdout.
+//     A file is paced: a line "@<frame>" holds everything after it until that
+//     loop iteration (counted from 0, like -n and -t); what comes before the
+//     first marker arrives at frame 0. A fifo is passed through as written.
+// -n  number of loop() iterations to run (default 200)
+// -o  raw dump of every shown frame, CURTAINS * LEDS_PER_CURTAIN * 3 bytes each
+// -t  per-frame stage timings as CSV, in host nanoseconds
+// -I  fifo read as the shard ring link (ShardLinkSerial RX)
+// -O  fifo written as the shard ring link (ShardLinkSerial TX)
+//
+// Simulated shards: one fifo per ring hop, each node started with its own
+// NODE command in the replay, e.g. for two nodes
+//   mkfifo l01 l10
+//   program -r node0.txt -I l10 -O l01 &  program -r node1.txt -I l01 -O l10
+//
+// Debug output (Serial) goes to stderr.
+#include <Arduino.h>
+#include <OctoWS2811.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "config.h"
+#include "profiler.h"
+
+void setup();
+void loop();
+
+static FILE *frameOut = nullptr;
+
+static void dumpFrame(const uint8_t *frame, uint32_t numBytes) {
+    fwrite(frame, 1, numBytes, frameOut);
+}
+
+// Paced replay of a -r file: parsed up to the next marker still in the
+// future, released bytes queued in replayOut and fed through a pipe
+static char *replayData = nullptr;
+static size_t replaySize = 0;
+static size_t replayPos = 0;
+static char *replayOut = nullptr;
+static size_t replayOutLen = 0;
+static size_t replayOutPos = 0;
+static int replayPipe = -1;
+
+// Whether a whole "@<frame>" line starts at pos; sets its frame and the
+// position after it
+static bool replayMarker(size_t pos, long &frame, size_t &next) {
+    if (replayData[pos] != '@') return false;
+    size_t p = pos + 1;
+    long v = 0;
+    size_t digits = 0;
+    while (p < replaySize && replayData[p] >= '0' && replayData[p] <= '9') {
+        v = v * 10 + (replayData[p++] - '0');
+        digits++;
+    }
+    if (!digits) return false;
+    if (p < replaySize && replayData[p] == '\r') p++;
+    if (p < replaySize && replayData[p] != '\n') return false;
+    frame = v;
+    next = p < replaySize ? p + 1 : p;
+    return true;
+}
+
+static bool replayOpenFile(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    replayData = (char *)malloc(size > 0 ? size : 1);
+    replayOut = (char *)malloc(size > 0 ? size : 1);
+    replaySize = replayData ? fread(replayData, 1, size > 0 ? size : 0, f) : 0;
+    fclose(f);
+
+    int fds[2];
+    if (!replayData || !replayOut || pipe(fds) < 0) return false;
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    replayPipe = fds[1];
+    CommunicationSerial.attach(fds[0], STDOUT_FILENO);
+    return true;
+}
+
+// Release the lines due by frame and push what the pipe takes
+static void replayRelease(long frame) {
+    while (replayPos < replaySize) {
+        long at;
+        size_t next;
+        if (replayMarker(replayPos, at, next)) {
+            if (at > frame) break;
+            replayPos = next;
+            continue;
+        }
+        const char *nl = (const char *)memchr(replayData + replayPos, '\n', replaySize - replayPos);
+        size_t end = nl ? (size_t)(nl - replayData) + 1 : replaySize;
+        memcpy(replayOut + replayOutLen, replayData + replayPos, end - replayPos);
+        replayOutLen += end - replayPos;
+        replayPos = end;
+    }
+    // a full pipe keeps the rest for the next frame
+    while (replayOutPos < replayOutLen) {
+        ssize_t n = write(replayPipe, replayOut + replayOutPos, replayOutLen - replayOutPos);
+        if (n <= 0) break;
+        replayOutPos += (size_t)n;
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "usage: %s [-r replay] [-n frames] [-o frames.rgb] [-t timings.csv] [-I link_in -O link_out]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    const char *replayPath = nullptr;
+    const char *framePath = nullptr;
+    const char *timingPath = nullptr;
+    const char *linkInPath = nullptr;
+    const char *linkOutPath = nullptr;
+    long frames = 200;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "r:n:o:t:I:O:h")) != -1) {
+        switch (opt) {
+            case 'r': replayPath = optarg; break;
+            case 'n': frames = atol(optarg); break;
+            case 'o': framePath = optarg; break;
+            case 't': timingPath = optarg; break;
+            case 'I': linkInPath = optarg; break;
+            case 'O': linkOutPath = optarg; break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    struct stat st;
+    if (replayPath && stat(replayPath, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (!replayOpenFile(replayPath)) {
+            perror(replayPath);
+            return 1;
+        }
+    } else if (replayPath) {
+        // non-blocking so a fifo with no writer yet doesn't stall the loop
+        int fd = open(replayPath, O_RDONLY | O_NONBLOCK);
+        if (fd < 0) {
+            perror(replayPath);
+            return 1;
+        }
+        CommunicationSerial.attach(fd, STDOUT_FILENO);
+    }
+
+    if (linkInPath || linkOutPath) {
+        // O_RDWR on the write side so opening a fifo doesn't wait for the peer
+        int in = linkInPath ? open(linkInPath, O_RDONLY | O_NONBLOCK) : -1;
+        int out = linkOutPath ? open(linkOutPath, O_RDWR) : -1;
+        if ((linkInPath && in < 0) || (linkOutPath && out < 0)) {
+            perror("link");
+            return 1;
+        }
+        ShardLinkSerial.attach(in, out);
+    }
+
+    if (framePath) {
+        frameOut = fopen(framePath, "wb");
+        if (!frameOut) {
+            perror(framePath);
+            return 1;
+        }
+        OctoWS2811::hook = dumpFrame;
+    }
+
+    FILE *timingOut = nullptr;
+    if (timingPath) {
+        timingOut = fopen(timingPath, "w");
+        if (!timingOut) {
+            perror(timingPath);
+            return 1;
+        }
+        fprintf(timingOut, "frame");
+        for (uint8_t s = 0; s < PROF_STAGE_COUNT; s++) fprintf(timingOut, ",%s_ns", profilerStageName((ProfileStage)s));
+        fprintf(timingOut, "\n");
+    }
+
+    setup();
+    for (long i = 0; i < frames; i++) {
+        if (replayPipe >= 0) replayRelease(i);
+        loop();
+        if (timingOut) {
+            fprintf(timingOut, "%ld", i);
+            for (uint8_t s = 0; s < PROF_STAGE_COUNT; s++) {
+                fprintf(timingOut, ",%lu", (unsigned long)profilerLastCycles((ProfileStage)s));
+            }
+            fprintf(timingOut, "\n");
+        }
+    }
+
+    if (timingOut) fclose(timingOut);
+    if (frameOut) fclose(frameOut);
+    free(replayData);
+    free(replayOut);
+    fprintf(stderr, "%ld frames, %lu shown\n", frames, (unsigned long)OctoWS2811::shows);
+    return 0;
+}
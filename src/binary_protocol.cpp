@@ -0,0 +1,45 @@
+#include "binary_protocol.h"
+
+// 4-bit table for CRC-16/CCITT-FALSE: two lookups per byte
+static const uint16_t crcNibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t crc16Update(uint16_t crc, uint8_t b) {
+    crc = (uint16_t)((crc << 4) ^ crcNibble[((crc >> 12) ^ (b >> 4)) & 0x0F]);
+    crc = (uint16_t)((crc << 4) ^ crcNibble[((crc >> 12) ^ (b & 0x0F)) & 0x0F]);
+    return crc;
+}
+
+uint16_t crc16(const uint8_t *data, size_t len, uint16_t crc) {
+    while (len--) crc = crc16Update(crc, *data++);
+    return crc;
+}
+
+bool binHeaderValid(uint8_t id, uint8_t len) {
+    switch (id) {
+        case BIN_ADD_STAR_CENTER:       return len >= 8 && len <= 14;
+        case BIN_BUILDUP_CLIMAX_CENTER: return len == 6;
+        case BIN_START_CLIMAX_CENTER:   return len == 10;
+        case BIN_PING:                  return len == 0;
+        case BIN_WIRING_MAP:            return len >= 5 && ((len - 3) & 1) == 0;
+        case BIN_STAR_HANDOFF:          return len == BIN_HANDOFF_LEN;
+        case BIN_SYNC:                  return len == BIN_SYNC_LEN;
+        default:                        return false;
+    }
+}
+
+void sendBinaryFrame(Print &out, uint8_t id, const uint8_t *payload, uint8_t len) {
+    uint8_t head[3] = { BIN_MAGIC, id, len };
+    uint16_t crc = crc16(head + 1, 2);
+    crc = crc16(payload, len, crc);
+    uint8_t tail[2] = { (uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8) };
+    out.write(head, sizeof(head));
+    if (len) out.write(payload, len);
+    out.write(tail, sizeof(tail));
+}
+
+void sendBinaryAck(Print &out, uint8_t id, uint8_t status) {
+    sendBinaryFrame(out, id | BIN_ACK_FLAG, &status, 1);
+}
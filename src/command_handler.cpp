@@ -3,29 +3,32 @@
 #include "config.h"
 #include "../include/commands/star_command_handler.h"
 #include "../include/commands/climax_command_handler.h"
+#include "../include/commands/system_command_handler.h"
 #include "../lib/PingPong.h"
+#include "serial_framer.h"
+#include "binary_protocol.h"
+#include "log.h"
 
-// Serial command buffer
-static String cmdBuffer = "";
+// Serial command framing
+static SerialFramer framer;
+static unsigned long framesReceived = 0;
 
-// Handler registry
-static BaseCommandHandler* handlers[20];
-static int handlerCount = 0;
+// Command name / binary id -> handler method
+static CommandRegistry registry;
 
 // Helper to build error response
-void buildError(cmdlib::Command &resp, const String &command, const String &message, const String &dst) {
+void buildError(cmdlib::Command &resp, const char *command, const char *message, const char *dst) {
     resp.clear();
-    if (dst != "" )
+    if (dst[0] != '\0')
         resp.addHeader(dst);
-    resp.command = command;
-    resp.msgKind = "ERROR";
+    resp.setCommand(command);
+    resp.setMsgKind("ERROR");
     resp.setNamed("message", message);
 }
 
 void registerHandler(BaseCommandHandler *handler) {
-    handlers[handlerCount++] = handler;
-    Serial.print("Registered handler: ");
-    Serial.println(handler->getName());
+    handler->registerCommands(registry);
+    LOG_INFO("Registered handler: %s", handler->getName());
 }
 
 void commandHandlerInit() {
@@ -37,79 +40,115 @@ void commandHandlerInit() {
     registerHandler(&starHandler);
     static ClimaxCommandHandler climaxHandler;
     registerHandler(&climaxHandler);
+    static SystemCommandHandler systemHandler;
+    registerHandler(&systemHandler);
 }
 
-void processSerialCommands() {
-    while (CommunicationSerial.available() > 0) {
-        char c = CommunicationSerial.read();
-
-        // If buffer is empty, wait for the start sequence "!!"
-        if (cmdBuffer.length() == 0) {
-            // Shift in chars until we detect "!!"
-            static String startDetect = "";
-            startDetect += c;
-
-            if (startDetect.length() > 2) {
-                startDetect.remove(0, 1); // keep only last 2 chars
-            }
-
-            if (startDetect == "!!") {
-                cmdBuffer = "!!"; // start the buffer with "!!"
-                startDetect = ""; // reset
-            }
-
-            // don't add anything else until we find "!!"
-            continue;
-        }
+// Parse and dispatch one complete "!!...##" frame
+static void dispatchFrame(const char *frame, size_t len) {
+    cmdlib::Command cmd;
+    const char *error;
 
-        // If we're already capturing the command, just append
-        cmdBuffer += c;
-
-        // Check for end of command "##"
-        if (cmdBuffer.endsWith("##")) {
-            cmdlib::Command cmd;
-            String error;
-
-            if (cmdlib::parse(cmdBuffer, cmd, error)) {
-                if (cmd.command == "PING") {
-                    PingPong.processCommand(cmd);
-                } else {
-                    handleCommand(cmd);
-                }
-            } else {
-                cmdlib::Command errResp;
-                buildError(errResp, cmd.command, "Parse failed: " + error, cmd.getHeader(0));
-                CommunicationSerial.println(cmdBuffer);
-                sendResponse(errResp);
-            }
-
-            cmdBuffer = "";
+    if (cmdlib::parse(frame, len, cmd, error)) {
+        if (cmd.isCommand("PING")) {
+            PingPong.processCommand(cmd);
+        } else {
+            handleCommand(cmd);
         }
+    } else {
+        cmdlib::Command errResp;
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Parse failed: %s", error);
+        LOG_WARN("%s", msg);
+        buildError(errResp, cmd.command(), msg, cmd.getHeader(0));
+        CommunicationSerial.write((const uint8_t*)frame, len);
+        CommunicationSerial.println();
+        sendResponse(errResp);
+    }
+}
+
+// Dispatch one binary frame and answer with a binary status ack
+static void dispatchBinary(uint8_t id, const uint8_t *payload, uint8_t len) {
+    if (id == BIN_PING) {
+        PingPong.notePing();
+        sendBinaryAck(CommunicationSerial, id, BIN_STATUS_OK);
+        return;
+    }
+
+    cmdlib::Command response;
+    if (registry.dispatchBinary(id, payload, len, response)) {
+        uint8_t status = BIN_STATUS_OK;
+        // handlers flag a wrong payload size with status (buildLengthError)
+        if (response.isMsgKind("ERROR")) status = (uint8_t)response.getInt("status", BIN_STATUS_ERROR);
+        sendBinaryAck(CommunicationSerial, id, status);
+        return;
+    }
+
+    sendBinaryAck(CommunicationSerial, id, BIN_STATUS_UNKNOWN_ID);
+}
+
+// Act on one framer result
+static void handleFramerResult(SerialFramer::Result r) {
+    if (r != SerialFramer::NONE) framesReceived++;
+
+    if (r == SerialFramer::FRAME) {
+        dispatchFrame(framer.frame(), framer.length());
+    } else if (r == SerialFramer::TOO_LONG) {
+        cmdlib::Command errResp;
+        buildError(errResp, "", "Frame too long", "MASTER");
+        sendResponse(errResp);
+    } else if (r == SerialFramer::BINARY) {
+        dispatchBinary(framer.binaryId(), framer.payload(), framer.payloadLength());
+    } else if (r == SerialFramer::BAD_CRC) {
+        sendBinaryAck(CommunicationSerial, framer.binaryId(), BIN_STATUS_BAD_CRC);
+    }
+}
+
+void processSerialCommands() {
+    // Bounded per call so an input burst can't stall the frame; the rest
+    // stays in the serial driver's buffer until the next call.
+    int budget = SERIAL_BYTE_BUDGET;
+    while (budget-- > 0 && CommunicationSerial.available() > 0) {
+        handleFramerResult(framer.push((uint8_t)CommunicationSerial.read()));
+        // bytes behind a rejected binary frame get a second pass
+        while (framer.pending()) handleFramerResult(framer.resume());
     }
 }
 
+unsigned long commandFramesReceived() {
+    return framesReceived;
+}
+
+const SerialFramer &commandFramer() {
+    return framer;
+}
+
 
 void handleCommand(const cmdlib::Command &cmd) {
-    // Try each registered handler
-    for (int i = 0; i < handlerCount; i++) {
-        if (handlers[i]->canHandle(cmd.command)) {
-            cmdlib::Command response;
-            handlers[i]->handle(cmd, response);
-            sendResponse(response);
-            return;
+    // One hash lookup, however many commands are registered
+    cmdlib::Command response;
+    if (registry.dispatch(cmd, response)) {
+        if (response.overflowed) {
+            // never send a reply with fields silently missing
+            LOG_ERROR("%s reply overflowed CMDLIB_MAX_PARAMS/CMDLIB_BUF_SIZE", cmd.command());
+            buildError(response, cmd.command(), "Response too large", cmd.getHeader(0));
         }
+        sendResponse(response);
+        return;
     }
 
     // No handler found
-    cmdlib::Command response;
-    response.msgKind = "ERROR";
-    response.command = cmd.command;
-    response.setNamed("message", "No handler for type: " + cmd.command);
+    response.clear();
+    char msg[64];
+    snprintf(msg, sizeof(msg), "No handler for type: %s", cmd.command());
+    response.setMsgKind("ERROR");
+    response.setCommand(cmd.command());
+    response.setNamed("message", msg);
     sendResponse(response);
 }
 
 void sendResponse(const cmdlib::Command &response) {
-    CommunicationSerial.println(response.toString());
+    response.printlnTo(CommunicationSerial);
 }
 
 // Simple free memory estimation (Teensy)
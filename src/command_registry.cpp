@@ -0,0 +1,89 @@
+#include "command_registry.h"
+#include "log.h"
+
+// FNV-1a over the command name
+uint32_t CommandRegistry::hashName(const char *name) {
+    uint32_t h = 2166136261u;
+    while (*name) {
+        h ^= (uint8_t)*name++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+const CommandRegistry::TextEntry *CommandRegistry::find(const char *name) const {
+    if (!capacity) return nullptr;
+    uint32_t h = hashName(name);
+    uint16_t mask = capacity - 1;
+    for (uint16_t i = h & mask;; i = (i + 1) & mask) {
+        const TextEntry &e = slots[i];
+        if (!e.name) return nullptr;
+        if (e.hash == h && strcmp(e.name, name) == 0) return &e;
+    }
+}
+
+bool CommandRegistry::grow() {
+    uint16_t newCapacity = capacity ? capacity * 2 : 16;
+    TextEntry *newSlots = (TextEntry*) calloc(newCapacity, sizeof(TextEntry));
+    if (!newSlots) return false;
+
+    uint16_t mask = newCapacity - 1;
+    for (uint16_t i = 0; i < capacity; i++) {
+        if (!slots[i].name) continue;
+        uint16_t j = slots[i].hash & mask;
+        while (newSlots[j].name) j = (j + 1) & mask;
+        newSlots[j] = slots[i];
+    }
+
+    free(slots);
+    slots = newSlots;
+    capacity = newCapacity;
+    return true;
+}
+
+bool CommandRegistry::addText(const char *name, BaseCommandHandler *handler, TextMethod method) {
+    if (find(name)) {
+        LOG_ERROR("duplicate command %s from %s", name, handler->getName());
+        return false;
+    }
+    // keep the load factor at or below 1/2 so probes stay short
+    if ((count + 1) * 2 > capacity && !grow()) return false;
+
+    uint32_t h = hashName(name);
+    uint16_t mask = capacity - 1;
+    uint16_t i = h & mask;
+    while (slots[i].name) i = (i + 1) & mask;
+
+    slots[i].hash = h;
+    slots[i].name = name;
+    slots[i].handler = handler;
+    slots[i].method = method;
+    count++;
+    return true;
+}
+
+bool CommandRegistry::addBinaryEntry(uint8_t id, BaseCommandHandler *handler, BinaryMethod method) {
+    if (binarySlot[id] != 0xFF || binaryCount >= MAX_BINARY) {
+        LOG_ERROR("cannot register binary id %d from %s", (int)id, handler->getName());
+        return false;
+    }
+    binaryEntries[binaryCount].handler = handler;
+    binaryEntries[binaryCount].method = method;
+    binarySlot[id] = binaryCount++;
+    return true;
+}
+
+bool CommandRegistry::dispatch(const cmdlib::Command &cmd, cmdlib::Command &response) const {
+    const TextEntry *e = find(cmd.command());
+    if (!e) return false;
+    (e->handler->*(e->method))(cmd, response);
+    return true;
+}
+
+bool CommandRegistry::dispatchBinary(uint8_t id, const uint8_t *payload, uint8_t len, cmdlib::Command &response) const {
+    uint8_t slot = binarySlot[id];
+    if (slot == 0xFF) return false;
+    const BinaryEntry &e = binaryEntries[slot];
+    (e.handler->*(e.method))(payload, len, response);
+    return true;
+}
@@ -1,307 +1,170 @@
 #include "commands/climax_command_handler.h"
 #include "config.h"
 #include "stars.h"
-
-#include <stdlib.h>
-#include <math.h>
+#include "tween.h"
 
 // ─────────────────────────────────────────────────────────────────────────────
-// Global state for climax animations
+// Climax effects as animation tracks (tween.h) over the star modulators:
+// nothing per star is backed up, rewritten or restored.
 // ─────────────────────────────────────────────────────────────────────────────
-static bool           climaxBuildupActive   = false;
-static bool           climaxSpiralActive    = false;
-static unsigned long  climaxStartTime       = 0;
-static float          climaxDuration        = 0;        // milliseconds
-static float          targetSpeedMultiplier = 1.0f;     // reused as spiralSpeed during spiral mode
-static float          originalMinSpeed      = 0;
-static float          originalMaxSpeed      = 0;
+#define TRACK_SPEED  "climax.speed"
+#define TRACK_CLIMB  "climax.climb"
+#define TRACK_BRIGHT "climax.bright"
+#define TRACK_WOBBLE "climax.wobble"
+#define TRACK_PHASE  "climax.phase"
+
+// Spiral wobble amplitude in rows before verticalBias, fixed at compile time
+static const float wobbleAmp = 0.5f * (float)CURTAIN_HEIGHT / (float)(TOTAL_WIDTH > 1 ? TOTAL_WIDTH : 1);
+
+static void stopClimaxTracks() {
+    tweenStop(TRACK_SPEED);
+    tweenStop(TRACK_CLIMB);
+    tweenStop(TRACK_BRIGHT);
+    tweenStop(TRACK_WOBBLE);
+    tweenStop(TRACK_PHASE);
+    starsResetModulators();
+}
 
-static int*           originalRows          = nullptr;  // per-star starting row (for time-based lerp)
-static float*         originalStarSpeeds    = nullptr;  // per-star horizontal speed backup
-static float*         originalBrightness    = nullptr;  // per-star starting brightness
+static void sendClimaxEvent(const char *event) {
+    cmdlib::Command finishCommand;
+    finishCommand.addHeader("MASTER");
+    finishCommand.setMsgKind("REQUEST");
+    finishCommand.setCommand(event);
+    finishCommand.printlnTo(CommunicationSerial);
+}
 
-// Extra control for slight vertical emphasis on very wide matrices
-static float          verticalBias          = 1.0f;     // small bias to increase perceived upward motion
+// Buildup reached full speed and held it for the rest of the duration
+static void onBuildUpDone() {
+    starsResetModulators();
+    sendClimaxEvent("CLIMAX_READY");
+}
 
-// For optional buildup (kept from your original)
-static float          originalFadeFactor    = 0;
-static int            buildupStarsAdded     = 0;
+// Spiral finished: every star has climbed to the top and faded out
+static void onSpiralDone() {
+    stopClimaxTracks();
+    starsClear();
+    sendClimaxEvent("CLIMAX_DONE_CENTER");
+}
 
 // ─────────────────────────────────────────────────────────────────────────────
-// Helper: Clear all stars + (optionally) the physical LEDs
+// Command handling
 // ─────────────────────────────────────────────────────────────────────────────
-static inline void clearAllStarsAndLeds() {
-    if (starsArr) {
-        for (int i = 0; i < activeStarCount; i++) {
-            starsArr[i].bright = 0.0f;
-        }
+void ClimaxCommandHandler::handleBuildUpBinary(const uint8_t *payload, uint8_t len, cmdlib::Command &response) {
+    if (len < 6) {
+        buildLengthError(response, "BUILDUP_CLIMAX_CENTER", len);
+        return;
     }
-    activeStarCount = 0;
-
-    // If you have a dedicated LED clear function in your renderer, call it:
-    // extern void clearAllLeds();
-    // clearAllLeds();
+    startBuildUp("BUILDUP_CLIMAX_CENTER", "MASTER",
+                 binReadU32(payload) / 1000.0f,
+                 binReadU16(payload + 4) / 100.0f,
+                 response);
 }
 
-// ─────────────────────────────────────────────────────────────────────────────
-// Command handling
-// ─────────────────────────────────────────────────────────────────────────────
-void ClimaxCommandHandler::handle(const cmdlib::Command &cmd, cmdlib::Command &response) {
-    if (cmd.command == "BUILDUP_CLIMAX_CENTER") {
-        handleBuildUp(cmd, response);
-    } else if (cmd.command == "START_CLIMAX_CENTER") {
-        handleStart(cmd, response);
+void ClimaxCommandHandler::handleStartBinary(const uint8_t *payload, uint8_t len, cmdlib::Command &response) {
+    if (len < 10) {
+        buildLengthError(response, "START_CLIMAX_CENTER", len);
+        return;
     }
+    startSpiral("START_CLIMAX_CENTER", "MASTER",
+                binReadU32(payload) / 1000.0f,
+                binReadU16(payload + 4) / 100.0f,
+                binReadU16(payload + 6) / 100.0f,
+                binReadU16(payload + 8) / 100.0f,
+                response);
 }
 
 void ClimaxCommandHandler::handleBuildUp(const cmdlib::Command &cmd, cmdlib::Command &response) {
-    // Parse duration parameter (in seconds)
-    float duration = cmd.getNamed("duration", "10.0").toFloat();
+    startBuildUp(cmd.command(), cmd.getHeader(0),
+                 cmd.getFloat("duration", 10.0f),          // seconds
+                 cmd.getFloat("speedMultiplier", 5.0f),
+                 response);
+}
+
+void ClimaxCommandHandler::handleStart(const cmdlib::Command &cmd, cmdlib::Command &response) {
+    startSpiral(cmd.command(), cmd.getHeader(0),
+                cmd.getFloat("duration", 15.0f),           // seconds
+                cmd.getFloat("spiralSpeed", 0.5f),         // rows per second influence
+                cmd.getFloat("speedMultiplier", 5.0f),
+                cmd.getFloat("verticalBias", 1.2f),
+                response);
+}
+
+void ClimaxCommandHandler::startBuildUp(const char *command, const char *src, float duration, float speedMultiplier,
+                                        cmdlib::Command &response) {
+    // Validate duration (in seconds)
     if (duration <= 0 || duration > 120) {
-        buildError(response, cmd.command, "Invalid duration. Must be between 0 and 120 seconds.", cmd.getHeader(0));
+        buildError(response, command, "Invalid duration. Must be between 0 and 120 seconds.", src);
         return;
     }
 
-    // Parse target speed multiplier
-    targetSpeedMultiplier = cmd.getNamed("speedMultiplier", "5.0").toFloat();
-    if (targetSpeedMultiplier < 1.0f || targetSpeedMultiplier > 20.0f) {
-        targetSpeedMultiplier = 5.0f;
+    // Target speed multiplier
+    if (speedMultiplier < 1.0f || speedMultiplier > 20.0f) {
+        speedMultiplier = 5.0f;
     }
 
-    // Store original speeds and fade factor
-    originalMinSpeed   = minSpeedColsPerSec;
-    originalMaxSpeed   = maxSpeedColsPerSec;
-    originalFadeFactor = fadeFactor;
-
-    // Allocate memory for backups
-    if (!originalStarSpeeds) originalStarSpeeds = (float*) malloc(sizeof(float) * MAX_STARS);
-    if (!originalBrightness) originalBrightness = (float*) malloc(sizeof(float) * MAX_STARS);
-    if (!originalRows)       originalRows       = (int*)   malloc(sizeof(int)   * MAX_STARS);
-
-    // Store per-star originals
-    if (starsArr && originalStarSpeeds && originalBrightness && originalRows) {
-        for (int i = 0; i < activeStarCount; i++) {
-            originalStarSpeeds[i] = starsArr[i].vx;
-            originalBrightness[i]  = starsArr[i].bright;
-            originalRows[i]        = starsArr[i].row;
-        }
+    // First 70%: gradual acceleration; last 30%: full speed
+    const TweenKey speed[] = {
+        { 0.0f, 1.0f,            EASE_LINEAR },
+        { 0.7f, speedMultiplier, EASE_LINEAR },
+        { 1.0f, speedMultiplier, EASE_HOLD },
+    };
+
+    stopClimaxTracks();
+    if (tweenStart(TRACK_SPEED, &starMods.speedScale, speed, 3,
+                   (unsigned long)(duration * 1000.0f), onBuildUpDone) < 0) {
+        buildError(response, command, "No free animation track", src);
+        return;
     }
 
-    // Reset buildup stars counter
-    buildupStarsAdded = 0;
-
-    // Activate buildup mode
-    climaxBuildupActive = true;
-    climaxSpiralActive  = false;
-    climaxStartTime     = millis();
-    climaxDuration      = duration * 1000.0f; // ms
-
-    buildResponse(response, cmd.command, "MASTER");
+    buildResponse(response, command, "MASTER");
 }
 
-void ClimaxCommandHandler::handleStart(const cmdlib::Command &cmd, cmdlib::Command &response) {
-    // Parse duration parameter (in seconds)
-    float duration = cmd.getNamed("duration", "15.0").toFloat();
+void ClimaxCommandHandler::startSpiral(const char *command, const char *src, float duration, float spiralSpeed,
+                                       float speedMultiplier, float bias, cmdlib::Command &response) {
+    // Validate duration (in seconds)
     if (duration <= 0 || duration > 120) {
-        buildError(response, cmd.command, "Invalid duration. Must be between 0 and 120 seconds.", cmd.getHeader(0));
+        buildError(response, command, "Invalid duration. Must be between 0 and 120 seconds.", src);
         return;
     }
 
-    // Parse spiral "wobble" speed (only affects the slight vertical wobble, not the time-based climb)
-    float spiralSpeed = cmd.getNamed("spiralSpeed", "0.5").toFloat(); // rows per second influence
+    // Spiral "wobble" speed (only affects the slight vertical wobble, not the time-based climb)
     if (spiralSpeed <= 0 || spiralSpeed > 5.0f) {
         spiralSpeed = 0.5f;
     }
 
-    // Parse horizontal speed multiplier (kept for your star field's x-velocity feel)
-    float speedMultiplier = cmd.getNamed("speedMultiplier", "5.0").toFloat();
+    // Horizontal speed multiplier (kept for the star field's x-velocity feel)
     if (speedMultiplier < 1.0f || speedMultiplier > 10.0f) {
         speedMultiplier = 5.0f;
     }
 
-    // Slight extra push for very wide canvases (optional)
-    verticalBias = cmd.getNamed("verticalBias", "1.2").toFloat();
-    if (verticalBias < 1.0f) verticalBias = 1.0f;
-
-    // Store original global speeds
-    originalMinSpeed = minSpeedColsPerSec;
-    originalMaxSpeed = maxSpeedColsPerSec;
-
-    // Allocate backups
-    if (!originalRows)       originalRows       = (int*)   malloc(sizeof(int)   * MAX_STARS);
-    if (!originalStarSpeeds) originalStarSpeeds = (float*) malloc(sizeof(float) * MAX_STARS);
-    if (!originalBrightness) originalBrightness = (float*) malloc(sizeof(float) * MAX_STARS);
-
-    // Backup per-star data + apply horizontal speed boost
-    if (starsArr && originalRows && originalStarSpeeds) {
-        for (int i = 0; i < activeStarCount; i++) {
-            originalRows[i]        = starsArr[i].row;
-            originalStarSpeeds[i]  = starsArr[i].vx;
-            originalBrightness[i]  = starsArr[i].bright;
-            starsArr[i].vx         = originalStarSpeeds[i] * speedMultiplier;
-        }
-    }
-
-    // Set global speeds to high values for horizontal motion feel
-    minSpeedColsPerSec = originalMinSpeed * speedMultiplier;
-    maxSpeedColsPerSec = originalMaxSpeed * speedMultiplier;
-
-    // Activate spiral mode
-    climaxSpiralActive    = true;
-    climaxBuildupActive   = false;
-    climaxStartTime       = millis();
-    climaxDuration        = duration * 1000.0f; // ms
-    targetSpeedMultiplier = spiralSpeed;        // wobble influence
-
-    buildResponse(response, cmd.command, "MASTER");
-}
-
-// ─────────────────────────────────────────────────────────────────────────────
-// Main updater
-// ─────────────────────────────────────────────────────────────────────────────
-void updateClimaxEffects() {
-    if (!climaxBuildupActive && !climaxSpiralActive) return;
-
-    unsigned long now     = millis();
-    unsigned long elapsed = now - climaxStartTime;
-
-    if (climaxBuildupActive) {
-        if (elapsed < climaxDuration) {
-            float progress = (climaxDuration > 0.0f) ? (float)elapsed / climaxDuration : 1.0f;
-            float speedMultiplier;
-
-            // First 70%: gradual acceleration; last 30%: full speed
-            if (progress < 0.7f) {
-                float accelProgress = progress / 0.7f; // 0..1
-                speedMultiplier = 1.0f + (targetSpeedMultiplier - 1.0f) * accelProgress;
-            } else {
-                speedMultiplier = targetSpeedMultiplier;
-            }
-
-            // Apply to globals
-            minSpeedColsPerSec = originalMinSpeed * speedMultiplier;
-            maxSpeedColsPerSec = originalMaxSpeed * speedMultiplier;
-
-            // Apply to stars based on ORIGINAL speeds
-            if (starsArr && originalStarSpeeds) {
-                for (int i = 0; i < activeStarCount; i++) {
-                    starsArr[i].vx = originalStarSpeeds[i] * speedMultiplier;
-                }
-            }
-        } else {
-            // Restore
-            minSpeedColsPerSec = originalMinSpeed;
-            maxSpeedColsPerSec = originalMaxSpeed;
-
-            if (starsArr && originalStarSpeeds) {
-                for (int i = 0; i < activeStarCount; i++) {
-                    starsArr[i].vx = originalStarSpeeds[i];
-                }
-            }
-
-            cmdlib::Command finishCommand;
-            finishCommand.addHeader("MASTER");
-            finishCommand.msgKind = "REQUEST";
-            finishCommand.command = "CLIMAX_READY";
-            CommunicationSerial.println(finishCommand.toString());
-
-            climaxBuildupActive = false;
-        }
-    }
-
-    if (climaxSpiralActive) {
-        if (elapsed < climaxDuration) {
-            // Normalized progress 0..1 across the runtime
-            float progress = (climaxDuration > 0.0f) ? (float)elapsed / climaxDuration : 1.0f;
-
-            // Brightness fade driven by duration: slow at first, finishing at the end.
-            // Adjust exponent (>1 = slower fade initially).
-            const float fadeExp = 1.5f;
-            float fade = 1.0f - powf(progress, fadeExp);
-            if (fade < 0.0f) fade = 0.0f;
-
-            // Optional wide-matrix vertical emphasis (just affects wobble magnitude)
-            float aspect = 1.0f;
-            #if defined(TOTAL_WIDTH) && defined(CURTAIN_HEIGHT)
-                if (CURTAIN_HEIGHT > 0) {
-                    float ratio = (float)TOTAL_WIDTH / (float)CURTAIN_HEIGHT;
-                    if (ratio > 1.0f) aspect = ratio;
-                }
-            #endif
-
-            if (starsArr && originalRows && originalBrightness) {
-                // We compute vertical position as a time-based lerp so all stars
-                // reach the TOP (row 0) exactly when progress -> 1.0
-                for (int i = 0; i < activeStarCount; i++) {
-                    Star &s = starsArr[i];
-
-                    float startRow  = (float)originalRows[i];
-                    float targetRow = 0.0f; // reach top at the end of duration
-                    float newRow    = startRow + (targetRow - startRow) * progress;
-
-                    // Subtle vertical "wobble" to preserve spiral feel, scaled by aspect & user speed
-                    // Wobble is gentle so it won't fight the time-based climb.
-                    float wobbleAmp = 0.5f * ((float)CURTAIN_HEIGHT / fmaxf(1.0f, (float)TOTAL_WIDTH));
-                    #if !defined(TOTAL_WIDTH)
-                        float TOTAL_WIDTH = 100.0f; // safe fallback if not defined
-                    #endif
-                    #if !defined(CURTAIN_HEIGHT)
-                        float CURTAIN_HEIGHT = 26.0f; // safe fallback if not defined
-                    #endif
-                    float wobble = sinf((s.x / (float)TOTAL_WIDTH) * 6.28318f + progress * targetSpeedMultiplier)
-                                   * wobbleAmp * verticalBias * (1.0f - progress); // taper wobble near the end
-                    newRow += wobble;
-
-                    // Convert to int row for rendering with clamping (no wrap)
-                    int rowInt = (int)floorf(newRow + 0.5f); // round to nearest
-                    if (rowInt < 0) rowInt = 0; // keep visible until the end (hits top at t=1)
-                    #if defined(CURTAIN_HEIGHT)
-                        if (rowInt >= CURTAIN_HEIGHT) rowInt = CURTAIN_HEIGHT - 1;
-                    #else
-                        if (rowInt >= 26) rowInt = 25;
-                    #endif
-                    s.row = rowInt;
-
-                    // Apply duration-driven brightness fade
-                    s.bright = originalBrightness[i] * fade;
-                }
-            }
-        } else {
-            // Time's up — restore globals, then clear everything visually
-            minSpeedColsPerSec = originalMinSpeed;
-            maxSpeedColsPerSec = originalMaxSpeed;
-
-            // Restore horizontal speeds (not critical since we clear next)
-            if (starsArr && originalStarSpeeds) {
-                for (int i = 0; i < activeStarCount; i++) {
-                    starsArr[i].vx = originalStarSpeeds[i];
-                }
-            }
-
-            // Hard clear: stars + LEDs
-            clearAllStarsAndLeds();
-
-            climaxSpiralActive = false;
-
-            // Send buildup finished command
-            cmdlib::Command finishCommand;
-            finishCommand.addHeader("MASTER");
-            finishCommand.msgKind = "REQUEST";
-            finishCommand.command = "CLIMAX_DONE_CENTER";
-            CommunicationSerial.println(finishCommand.toString());
-        }
+    // Slight extra push for very wide canvases
+    if (bias < 1.0f) bias = 1.0f;
+
+    unsigned long ms = (unsigned long)(duration * 1000.0f);
+
+    // Time-based climb: every star reaches the top (row 0) exactly at the end
+    const TweenKey climb[]  = { { 0.0f, 0.0f, EASE_LINEAR }, { 1.0f, 1.0f, EASE_LINEAR } };
+    // Brightness fade: slow at first, finishing at the end
+    const TweenKey bright[] = { { 0.0f, 1.0f, EASE_LINEAR }, { 1.0f, 0.0f, EASE_IN_15 } };
+    // Gentle wobble that tapers out so it won't fight the climb
+    const TweenKey wobble[] = { { 0.0f, wobbleAmp * bias, EASE_LINEAR }, { 1.0f, 0.0f, EASE_LINEAR } };
+    // Wobble phase advances by spiralSpeed radians over the run
+    const TweenKey phase[]  = { { 0.0f, 0.0f, EASE_LINEAR }, { 1.0f, spiralSpeed / 6.28318531f, EASE_LINEAR } };
+
+    stopClimaxTracks();
+    starMods.speedScale = speedMultiplier;
+    // the wave already varies along x; the groups (random per star) start a
+    // fraction of a turn apart so stars in the same column don't rise in step
+    for (int g = 0; g < STAR_GROUPS; g++) starGroupMods[g].wobblePhase = (float)g / STAR_GROUPS;
+    bool ok = tweenStart(TRACK_BRIGHT, &starMods.brightScale, bright, 2, ms) >= 0
+           && tweenStart(TRACK_WOBBLE, &starMods.wobble, wobble, 2, ms) >= 0
+           && tweenStart(TRACK_PHASE, &starMods.wobblePhase, phase, 2, ms) >= 0
+           && tweenStart(TRACK_CLIMB, &starMods.climb, climb, 2, ms, onSpiralDone) >= 0;
+    if (!ok) {
+        stopClimaxTracks();
+        buildError(response, command, "No free animation track", src);
+        return;
     }
-}
 
-// ─────────────────────────────────────────────────────────────────────────────
-// Cleanup function (optional - call when shutting down)
-// ─────────────────────────────────────────────────────────────────────────────
-void cleanupClimaxEffects() {
-    if (originalRows)        { free(originalRows);        originalRows = nullptr; }
-    if (originalStarSpeeds)  { free(originalStarSpeeds);  originalStarSpeeds = nullptr; }
-    if (originalBrightness)  { free(originalBrightness);  originalBrightness = nullptr; }
+    buildResponse(response, command, "MASTER");
 }
-
-// Note: Add this to main.cpp loop:
-//   extern void updateClimaxEffects();
-//   updateClimaxEffects(); // call each frame
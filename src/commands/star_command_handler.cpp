@@ -2,46 +2,95 @@
 #include "config.h"
 #include "stars.h"
 
-void StarCommandHandler::handle(const cmdlib::Command &cmd, cmdlib::Command &response) {
-    if (cmd.command == "ADD_STAR_CENTER") {
-        handleAdd(cmd, response);
+void StarCommandHandler::handleAddBinary(const uint8_t *payload, uint8_t len, cmdlib::Command &response) {
+    // 8 base bytes, then optionally passes (9), passes and ttlMs (13), or
+    // passes, ttlMs and group (14)
+    if (len < 8 || (len > 9 && len < 13) || len > 14) {
+        buildLengthError(response, "ADD_STAR_CENTER", len);
+        return;
     }
-    else {
+    int hexColor = (payload[3] << 16) | (payload[4] << 8) | payload[5];
+    // optional lifetime: passes u8, ttlMs u32
+    int passes = len >= 9 ? payload[8] : 0;
+    long ttl = len >= 13 ? (long)binReadU32(payload + 9) : 0;
+    int group = len >= 14 ? payload[13] : -1;
+    addStars("ADD_STAR_CENTER", "MASTER", binReadU16(payload), payload[2], hexColor, payload[6], payload[7],
+             passes, ttl, group, response);
+}
 
+void StarCommandHandler::handleAdd(const cmdlib::Command &cmd, cmdlib::Command &response) {
+    int count = cmd.getInt("count", 1);
+    int speed = cmd.getInt("speed", 50);              // Default speed: 50
+    const char *colorStr = cmd.getNamed("color", "0xffc003");
+    int brightness = cmd.getInt("brightness", 255);   // Default brightness: 255
+    int size = cmd.getInt("size", 1);                 // Default size: 1
+    int passes = cmd.getInt("passes", 0);             // Default: no pass limit
+    long ttl = cmd.getInt("ttl", 0);                  // ms, default: no TTL
+    int group = cmd.getInt("group", -1);              // Default: random group
+
+    int hexColor;
+    if (strncmp(colorStr, "0x", 2) == 0) {
+        hexColor = (int)cmdlib::parseHexStr(colorStr);
+    } else {
+        hexColor = (int)cmdlib::parseIntStr(colorStr);
     }
+
+    addStars(cmd.command(), cmd.getHeader(0), count, speed, hexColor, brightness, size, passes, ttl, group, response);
 }
 
-void StarCommandHandler::handleAdd(const cmdlib::Command &cmd, cmdlib::Command &response) {
-    int count = cmd.getNamed("count", "1").toInt();
-    int speed = cmd.getNamed("speed", "50").toInt();      // Default speed: 50
-    String colorStr = cmd.getNamed("color", "0xffc003");
-    int brightness = cmd.getNamed("brightness", "255").toInt(); // Default brightness: 255
-    int size = cmd.getNamed("size", "1").toInt();         // Default size: 1
+// Shared by the text and binary paths: validate, then spawn
+void StarCommandHandler::addStars(const char *command, const char *src, int count, int speed, int hexColor,
+                                  int brightness, int size, int passes, long ttl, int group,
+                                  cmdlib::Command &response) {
+    char msg[64];
 
     if (count <= 0) {
-        buildError(response, cmd.command, "Count must be positive, got: " + String(count), cmd.getHeader(0));
+        snprintf(msg, sizeof(msg), "Count must be positive, got: %d", count);
+        buildError(response, command, msg, src);
         return;
     }
 
     // Validate other parameters as needed
     if (speed < 0 || speed > 100) {
-        buildError(response, cmd.command, "Speed must be between 0 and 100, got: " + String(speed), cmd.getHeader(0));
+        snprintf(msg, sizeof(msg), "Speed must be between 0 and 100, got: %d", speed);
+        buildError(response, command, msg, src);
         return;
     }
 
     if (brightness < 0 || brightness > 255) {
-        buildError(response, cmd.command, "Brightness must be between 0 and 255, got: " + String(brightness), cmd.getHeader(0));
+        snprintf(msg, sizeof(msg), "Brightness must be between 0 and 255, got: %d", brightness);
+        buildError(response, command, msg, src);
+        return;
+    }
+
+    if (size <= 0 || size > 255) {
+        snprintf(msg, sizeof(msg), "Size must be between 1 and 255, got: %d", size);
+        buildError(response, command, msg, src);
         return;
     }
 
-    if (size <= 0) {
-        buildError(response, cmd.command, "Size must be positive, got: " + String(size), cmd.getHeader(0));
+    if (passes < 0 || passes > 255) {
+        snprintf(msg, sizeof(msg), "Passes must be between 0 and 255, got: %d", passes);
+        buildError(response, command, msg, src);
+        return;
+    }
+
+    if (ttl < 0 || ttl > 3600000L) {
+        snprintf(msg, sizeof(msg), "TTL must be between 0 and 3600000 ms, got: %ld", ttl);
+        buildError(response, command, msg, src);
+        return;
+    }
+
+    if (group < -1 || group >= STAR_GROUPS) {
+        snprintf(msg, sizeof(msg), "Group must be between 0 and %d, got: %d", STAR_GROUPS - 1, group);
+        buildError(response, command, msg, src);
         return;
     }
 
     int available = MAX_STARS - activeStarCount;
     if (available <= 0) {
-        buildError(response, cmd.command,"Already at maximum stars (" + String(MAX_STARS) + ")", cmd.getHeader(0));
+        snprintf(msg, sizeof(msg), "Already at maximum stars (%d)", MAX_STARS);
+        buildError(response, command, msg, src);
         return;
     }
 
@@ -49,20 +98,8 @@ void StarCommandHandler::handleAdd(const cmdlib::Command &cmd, cmdlib::Command &
         count = available;
     }
 
-    int added = 0;
-    for (int i = 0; i < count && activeStarCount < MAX_STARS; i++) {
-        int hexColor;
-        if (colorStr.startsWith("0x")) {
-            hexColor = (int)strtol(colorStr.c_str() + 2, NULL, 16);
-        } else {
-            hexColor = colorStr.toInt();
-        }
-
-        // Assuming addStar function needs to be modified to accept these parameters
-        if (addStar(speed, hexColor, brightness, size)) {
-            added++;
-        }
-    }
+    int added = starsSpawn(count, speed, hexColor, brightness, size, (uint8_t)passes, (uint32_t)ttl, group);
 
-    buildResponse(response, cmd.command, "MASTER");
-}
\ No newline at end of file
+    buildResponse(response, command, "MASTER");
+    response.setNamed("added", added);
+}
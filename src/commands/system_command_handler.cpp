@@ -0,0 +1,310 @@
+#include "../../include/commands/system_command_handler.h"
+#include "config.h"
+#include "frame_scheduler.h"
+#include "command_handler.h"
+#include "mapping.h"
+#include "profiler.h"
+#include "log.h"
+#include "idle.h"
+#include "shard.h"
+#include "renderer.h"
+#include "lod.h"
+#include "stars.h"
+#include "prng.h"
+#include <errno.h>
+#include "../../lib/PingPong.h"
+
+// FRAME_RATE{fps=60} sets the target rate; without fps it only reports.
+void SystemCommandHandler::handleFrameRate(const cmdlib::Command &cmd, cmdlib::Command &response) {
+    if (cmd.hasNamed("fps")) {
+        float fps = cmd.getFloat("fps", 0.0f);
+        if (!frameSchedulerSetFps(fps)) {
+            char msg[64];
+            snprintf(msg, sizeof(msg), "FPS must be between 1 and 1000, got: %s", cmd.getNamed("fps"));
+            buildError(response, cmd.command(), msg, cmd.getHeader(0));
+            return;
+        }
+    }
+
+    buildResponse(response, cmd.command(), "MASTER");
+    response.setNamed("fps", frameSchedulerFps(), 2);
+    response.setNamed("periodUs", frameSchedulerPeriodUs());
+    response.setNamed("lastFrameUs", frameSchedulerLastFrameUs());
+    response.setNamed("overruns", frameSchedulerOverruns());
+}
+
+// WIRING{curtain=2,layout=SERPENTINE_ROWS,invert=1} re-wires one curtain and
+// rebuilds the pixel map; without a curtain it lists every curtain's wiring.
+void SystemCommandHandler::handleWiring(const cmdlib::Command &cmd, cmdlib::Command &response) {
+    char msg[64];
+    if (!cmd.hasNamed("curtain")) {
+        buildResponse(response, cmd.command(), "MASTER");
+        for (int c = 0; c < CURTAINS; c++) {
+            char key[8];
+            snprintf(key, sizeof(key), "c%d", c);
+            snprintf(msg, sizeof(msg), "%s%s", wiringName(curtainWiring[c]), invertCurtain[c] ? "/INVERT" : "");
+            response.setNamed(key, msg);
+        }
+        return;
+    }
+
+    int curtain = cmd.getInt("curtain", -1);
+    if (curtain < 0 || curtain >= CURTAINS) {
+        snprintf(msg, sizeof(msg), "Curtain must be between 0 and %d, got: %s", CURTAINS - 1, cmd.getNamed("curtain"));
+        buildError(response, cmd.command(), msg, cmd.getHeader(0));
+        return;
+    }
+
+    CurtainWiring wiring = curtainWiring[curtain];
+    if (cmd.hasNamed("layout") && !wiringFromName(cmd.getNamed("layout"), wiring)) {
+        snprintf(msg, sizeof(msg), "Unknown layout: %s", cmd.getNamed("layout"));
+        buildError(response, cmd.command(), msg, cmd.getHeader(0));
+        return;
+    }
+    if (wiring == WIRING_CUSTOM && !mappingHasCustom(curtain)) {
+        snprintf(msg, sizeof(msg), "No custom table loaded for curtain %d", curtain);
+        buildError(response, cmd.command(), msg, cmd.getHeader(0));
+        return;
+    }
+    bool invert = cmd.getInt("invert", invertCurtain[curtain] ? 1 : 0) != 0;
+
+    mappingSetCurtain(curtain, wiring, invert);
+    // canvas is unaffected; every LED moves, so all of them are rewritten
+    rendererInvalidate();
+
+    buildResponse(response, cmd.command(), "MASTER");
+    response.setNamed("curtain", curtain);
+    response.setNamed("layout", wiringName(wiring));
+    response.setNamed("invert", invert ? "1" : "0");
+}
+
+// Binary WIRING_MAP: one chunk of a custom per-LED table for a curtain. The
+// chunk completing the table switches the curtain to CUSTOM.
+void SystemCommandHandler::handleWiringMapBinary(const uint8_t *payload, uint8_t len, cmdlib::Command &response) {
+    if (len < 5 || ((len - 3) & 1)) {
+        buildLengthError(response, "WIRING_MAP", len);
+        return;
+    }
+    int curtain = payload[0];
+    int offset = binReadU16(payload + 1);
+    int count = (len - 3) / 2;
+    uint16_t entries[(BIN_MAX_PAYLOAD - 3) / 2];
+    for (int i = 0; i < count; i++) entries[i] = binReadU16(payload + 3 + 2 * i);
+
+    bool applied;
+    if (!mappingLoadCustom(curtain, offset, entries, count, applied)) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Bad table chunk: curtain %d, offset %d", curtain, offset);
+        buildError(response, "WIRING_MAP", msg, "MASTER");
+        return;
+    }
+    if (applied) rendererInvalidate();
+    buildResponse(response, "WIRING_MAP", "MASTER");
+}
+
+// Fields in the summary reply: samples, one per stage, then the counters.
+// Keep in step with handleStats; a Command drops fields past its limit.
+static const int STATS_FIELDS = 1 + PROF_STAGE_COUNT + 10;
+static_assert(STATS_FIELDS <= CMDLIB_MAX_PARAMS, "STATS reply needs more CMDLIB_MAX_PARAMS");
+
+// STATS reports min/avg/max/p99 microseconds per frame stage over the
+// profiler window. STATS{stage=fade} reports one stage in raw cycles;
+// reset=1 clears the window after reporting.
+void SystemCommandHandler::handleStats(const cmdlib::Command &cmd, cmdlib::Command &response) {
+    char msg[64];
+    ProfileSummary sum;
+
+    if (cmd.hasNamed("stage")) {
+        ProfileStage stage;
+        if (!profilerStageFromName(cmd.getNamed("stage"), stage)) {
+            snprintf(msg, sizeof(msg), "Unknown stage: %s", cmd.getNamed("stage"));
+            buildError(response, cmd.command(), msg, cmd.getHeader(0));
+            return;
+        }
+        profilerSummary(stage, sum);
+        buildResponse(response, cmd.command(), "MASTER");
+        response.setNamed("stage", profilerStageName(stage));
+        response.setNamed("samples", (unsigned long)sum.samples);
+        response.setNamed("min", (unsigned long)sum.minCycles);
+        response.setNamed("avg", (unsigned long)sum.avgCycles);
+        response.setNamed("max", (unsigned long)sum.maxCycles);
+        response.setNamed("p99", (unsigned long)sum.p99Cycles);
+        response.setNamed("unit", "cycles");
+    } else {
+        buildResponse(response, cmd.command(), "MASTER");
+        for (uint8_t s = 0; s < PROF_STAGE_COUNT; s++) {
+            profilerSummary((ProfileStage)s, sum);
+            if (s == 0) response.setNamed("samples", (unsigned long)sum.samples);
+            // min/avg/max/p99
+            snprintf(msg, sizeof(msg), "%lu/%lu/%lu/%lu",
+                     (unsigned long)profilerCyclesToUs(sum.minCycles),
+                     (unsigned long)profilerCyclesToUs(sum.avgCycles),
+                     (unsigned long)profilerCyclesToUs(sum.maxCycles),
+                     (unsigned long)profilerCyclesToUs(sum.p99Cycles));
+            response.setNamed(profilerStageName((ProfileStage)s), msg);
+        }
+        response.setNamed("overruns", frameSchedulerOverruns());
+        response.setNamed("lod", (int)lodLevel());
+        response.setNamed("activeStars", activeStarCount);
+        response.setNamed("expired", starsExpired());
+        response.setNamed("logDropped", (unsigned long)logDroppedCount());
+        // command port framing: bytes outside frames, frames too long,
+        // frames restarted by a fresh "!!", binary CRC failures, 0xB5s
+        // whose id/length made no sense
+        const SerialFramer &framer = commandFramer();
+        response.setNamed("discarded", (unsigned long)framer.discardedBytes());
+        response.setNamed("overflows", (unsigned long)framer.overflowCount());
+        response.setNamed("resyncs", (unsigned long)framer.resyncCount());
+        response.setNamed("crcErrors", (unsigned long)framer.crcErrorCount());
+        response.setNamed("badHeaders", (unsigned long)framer.badHeaderCount());
+    }
+
+    if (cmd.getInt("reset", 0) != 0) profilerReset();
+}
+
+// IDLE{screensaver=1} turns the idle twinkle on or off. Reports whether the
+// current frame is being skipped and how many frames idle mode has skipped.
+void SystemCommandHandler::handleIdle(const cmdlib::Command &cmd, cmdlib::Command &response) {
+    if (cmd.hasNamed("screensaver")) {
+        idleScreensaver = cmd.getInt("screensaver", 0) != 0;
+    }
+
+    buildResponse(response, cmd.command(), "MASTER");
+    response.setNamed("idle", idleActive() ? "1" : "0");
+    response.setNamed("pingIdle", PING_IDLE ? "1" : "0");
+    response.setNamed("screensaver", idleScreensaver ? "1" : "0");
+    response.setNamed("idleFrames", idleFrames());
+}
+
+// NODE{index=1,count=3,offset=100,width=300} places this controller in a
+// sharded canvas; without parameters it reports the layout and link counters.
+void SystemCommandHandler::handleNode(const cmdlib::Command &cmd, cmdlib::Command &response) {
+    if (cmd.hasNamed("index") || cmd.hasNamed("count") || cmd.hasNamed("offset") || cmd.hasNamed("width")) {
+        int index = cmd.getInt("index", nodeIndex);
+        int count = cmd.getInt("count", nodeCount);
+        int offset = cmd.getInt("offset", nodeColumnOffset);
+        int width = cmd.getInt("width", count > 1 ? globalWidth : TOTAL_WIDTH);
+        if (index < 0 || index > 255 || count < 1 || count > 255 ||
+            !shardConfigure((uint8_t)index, (uint8_t)count, offset, width)) {
+            char msg[64];
+            snprintf(msg, sizeof(msg), "Bad layout: node %d of %d at column %d of %d", index, count, offset, width);
+            buildError(response, cmd.command(), msg, cmd.getHeader(0));
+            return;
+        }
+    }
+
+    buildResponse(response, cmd.command(), "MASTER");
+    response.setNamed("index", (int)nodeIndex);
+    response.setNamed("count", (int)nodeCount);
+    response.setNamed("offset", nodeColumnOffset);
+    response.setNamed("width", globalWidth);
+    response.setNamed("frame", (unsigned long)shardFrame());
+    response.setNamed("sent", (unsigned long)shardStarsSent());
+    response.setNamed("received", (unsigned long)shardStarsReceived());
+    response.setNamed("syncs", (unsigned long)shardSyncsReceived());
+    response.setNamed("linkErrors", (unsigned long)shardLinkErrors());
+}
+
+// OUTPUT{gamma=2.2,dither=1} tunes the output stage; without parameters it
+// only reports. The gamma table is rebuilt on the next frame.
+void SystemCommandHandler::handleOutput(const cmdlib::Command &cmd, cmdlib::Command &response) {
+    if (cmd.hasNamed("gamma")) {
+        float gamma = cmd.getFloat("gamma", 0.0f);
+        if (gamma < 0.2f || gamma > 5.0f) {
+            char msg[64];
+            snprintf(msg, sizeof(msg), "Gamma must be between 0.2 and 5.0, got: %s", cmd.getNamed("gamma"));
+            buildError(response, cmd.command(), msg, cmd.getHeader(0));
+            return;
+        }
+        outputGamma = gamma;
+    }
+    if (cmd.hasNamed("dither")) {
+        outputDither = cmd.getInt("dither", 1) != 0;
+    }
+
+    buildResponse(response, cmd.command(), "MASTER");
+    response.setNamed("gamma", outputGamma, 2);
+    response.setNamed("dither", outputDither ? "1" : "0");
+}
+
+// POWER{limit=40000} sets the supply budget in mA (0 = unlimited); always
+// reports the live estimate before and after limiting.
+void SystemCommandHandler::handlePower(const cmdlib::Command &cmd, cmdlib::Command &response) {
+    if (cmd.hasNamed("limit")) {
+        long limit = cmd.getInt("limit", -1);
+        if (limit < 0) {
+            char msg[64];
+            snprintf(msg, sizeof(msg), "Limit must be 0 or more mA, got: %s", cmd.getNamed("limit"));
+            buildError(response, cmd.command(), msg, cmd.getHeader(0));
+            return;
+        }
+        // at or below the idle draw no scale could meet it; the wall would go black
+        if (limit > 0 && (unsigned long)limit <= rendererIdleMa()) {
+            char msg[64];
+            snprintf(msg, sizeof(msg), "Limit must be above the %lu mA idle draw, got: %s",
+                     (unsigned long)rendererIdleMa(), cmd.getNamed("limit"));
+            buildError(response, cmd.command(), msg, cmd.getHeader(0));
+            return;
+        }
+        powerLimitMa = (unsigned long)limit;
+        rendererUpdatePower();
+    }
+
+    buildResponse(response, cmd.command(), "MASTER");
+    response.setNamed("limitMa", powerLimitMa);
+    response.setNamed("idleMa", (unsigned long)rendererIdleMa());
+    response.setNamed("estimateMa", (unsigned long)rendererEstimatedMa());
+    response.setNamed("outputMa", (unsigned long)rendererOutputMa());
+    response.setNamed("scale", rendererPowerScale(), 3);
+}
+
+// LOD{level=2} pins a level of detail (0 = full) and stops adaptation;
+// LOD{auto=1} hands it back to the controller. Always reports the level,
+// the limits in force and how often the level changed.
+void SystemCommandHandler::handleLod(const cmdlib::Command &cmd, cmdlib::Command &response) {
+    if (cmd.hasNamed("level")) {
+        int level = cmd.getInt("level", -1);
+        if (level < 0 || level >= LOD_LEVELS) {
+            char msg[64];
+            snprintf(msg, sizeof(msg), "Level must be between 0 and %d, got: %s", LOD_LEVELS - 1, cmd.getNamed("level"));
+            buildError(response, cmd.command(), msg, cmd.getHeader(0));
+            return;
+        }
+        lodSetLevel((uint8_t)level);
+    }
+    if (cmd.hasNamed("auto")) {
+        lodSetAuto(cmd.getInt("auto", 1) != 0);
+    }
+
+    buildResponse(response, cmd.command(), "MASTER");
+    response.setNamed("level", (int)lodLevel());
+    response.setNamed("auto", lodAuto() ? "1" : "0");
+    response.setNamed("maxTrail", (int)lodLimits.maxTrail);
+    response.setNamed("snapBelow", (int)lodLimits.snapBelow);
+    response.setNamed("faintBelow", (int)lodLimits.faintBelow);
+    response.setNamed("cullBelow", (int)lodLimits.cullBelow);
+    response.setNamed("changes", lodChanges());
+}
+
+// SEED{value=1234} restarts the random sequence so a show replays with the
+// same stars; without value it only reports the seed in use.
+void SystemCommandHandler::handleSeed(const cmdlib::Command &cmd, cmdlib::Command &response) {
+    if (cmd.hasNamed("value")) {
+        // parsed here rather than with getInt: seeds use the full 32 bits
+        const char *text = cmd.getNamed("value");
+        char *end = nullptr;
+        errno = 0;
+        unsigned long seed = strtoul(text, &end, 0);
+        if (end == text || *end != '\0' || text[0] == '-' || errno == ERANGE
+            || (unsigned long long)seed > UINT32_MAX) {
+            char msg[64];
+            snprintf(msg, sizeof(msg), "Seed must be an unsigned 32-bit number, got: %s", text);
+            buildError(response, cmd.command(), msg, cmd.getHeader(0));
+            return;
+        }
+        prngSeed((uint32_t)seed);
+    }
+
+    buildResponse(response, cmd.command(), "MASTER");
+    response.setNamed("value", (unsigned long)prngSeedValue());
+}
@@ -1,19 +1,36 @@
 #include "../include/config.h"
+#include "../include/mapping.h"
 
 // per-curtain inversion (change as-needed)
 bool invertCurtain[CURTAINS] = { false, false, false, false, false };
 
+// per-curtain LED chaining (change as-needed, or at runtime via WIRING)
+CurtainWiring curtainWiring[CURTAINS] = {
+    WIRING_COLUMN_MAJOR, WIRING_COLUMN_MAJOR, WIRING_COLUMN_MAJOR, WIRING_COLUMN_MAJOR, WIRING_COLUMN_MAJOR
+};
+
 // runtime tunables default values
-const int MAX_STARS = 500; // maximum alloc size - change higher if you have RAM
+const int MAX_STARS = STAR_CAPACITY; // maximum alloc size - see config.h
 int activeStarCount = 0; // initial active stars (<= MAX_STARS)
 
 
 float minSpeedColsPerSec = 8.0f;
 float maxSpeedColsPerSec = 25.0f;
 float fadeFactor = 0.86f;
-unsigned long frameTargetMs = 1; // ~50 FPS
+float outputGamma = 1.0f;
+bool outputDither = true;
+unsigned long powerLimitMa = 0; // e.g. 40000 for a 5 V / 40 A supply
+unsigned long frameTargetMs = 20; // ~50 FPS (runtime: FRAME_RATE command)
 bool randomRows = true;
 bool wrapStars = false;
+bool idleScreensaver = false;
+uint32_t prngBootSeed = 0;
+
+// standalone by default; set per controller for a sharded wall
+uint8_t nodeIndex = 0;
+uint8_t nodeCount = 1;
+int nodeColumnOffset = 0;
+int globalWidth = TOTAL_WIDTH;
 
 uint8_t STAR_R = 255;
 uint8_t STAR_G = 191;
@@ -0,0 +1,18 @@
+#include "easing.h"
+#include <math.h>
+
+float sineLut[SINE_LUT_SIZE + 1];
+float easeIn15Lut[EASE_LUT_SIZE + 1];
+
+static bool easingReady = false;
+
+void easingInit() {
+    if (easingReady) return;
+    for (int i = 0; i <= SINE_LUT_SIZE; i++) {
+        sineLut[i] = sinf((float)i * (6.28318531f / SINE_LUT_SIZE));
+    }
+    for (int i = 0; i <= EASE_LUT_SIZE; i++) {
+        easeIn15Lut[i] = powf((float)i / EASE_LUT_SIZE, 1.5f);
+    }
+    easingReady = true;
+}
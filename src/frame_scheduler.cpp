@@ -0,0 +1,68 @@
+#include "frame_scheduler.h"
+#include "config.h"
+
+static unsigned long periodUs = 0;
+static unsigned long nextDeadline = 0;
+static unsigned long overruns = 0;
+static unsigned long lastFrameUs = 0;
+static bool externalClock = false;
+
+
+void frameSchedulerInit() {
+    periodUs = (frameTargetMs > 0 ? frameTargetMs : 1) * 1000UL;
+    nextDeadline = micros() + periodUs;
+    overruns = 0;
+    lastFrameUs = 0;
+}
+
+bool frameSchedulerSetFps(float fps) {
+    if (fps < 1.0f || fps > 1000.0f) return false;
+    periodUs = (unsigned long)(1000000.0f / fps + 0.5f);
+    frameTargetMs = (periodUs + 500UL) / 1000UL;
+    // re-anchor so the new rate starts from the current frame
+    nextDeadline = micros() + periodUs;
+    return true;
+}
+
+float frameSchedulerFps() {
+    return periodUs ? 1000000.0f / (float)periodUs : 0.0f;
+}
+
+unsigned long frameSchedulerPeriodUs() {
+    return periodUs;
+}
+
+void frameSchedulerEndFrame(unsigned long frameStartMicros) {
+    unsigned long now = micros();
+    lastFrameUs = now - frameStartMicros;
+
+    if ((long)(now - nextDeadline) > 0) {
+        // Missed the deadline: count it and re-anchor on now rather than
+        // rendering a burst of catch-up frames.
+        overruns++;
+        nextDeadline = now;
+    }
+}
+
+void frameSchedulerWait(void (*idleWork)()) {
+    while ((long)(nextDeadline - micros()) > 0) {
+        if (idleWork) idleWork();
+    }
+    nextDeadline += externalClock ? 2 * periodUs : periodUs;
+}
+
+void frameSchedulerSetExternalClock(bool external) {
+    externalClock = external;
+}
+
+void frameSchedulerAlign() {
+    nextDeadline = micros();
+}
+
+unsigned long frameSchedulerOverruns() {
+    return overruns;
+}
+
+unsigned long frameSchedulerLastFrameUs() {
+    return lastFrameUs;
+}
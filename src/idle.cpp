@@ -0,0 +1,53 @@
+#include "idle.h"
+#include "config.h"
+#include "renderer.h"
+#include "command_handler.h"
+#include "tween.h"
+#include "prng.h"
+#include "../lib/PingPong.h"
+
+static bool idle = false;
+static unsigned long lastFramesSeen = 0;
+static unsigned long skippedFrames = 0;
+static unsigned long lastTwinkleMs = 0;
+
+bool idleUpdate() {
+    unsigned long seen = commandFramesReceived();
+    bool woken = seen != lastFramesSeen;
+    lastFramesSeen = seen;
+
+    idle = !woken
+        && activeStarCount == 0
+        && tweenActiveCount() == 0
+        && !rendererNeedsShow();
+    if (idle) skippedFrames++;
+    return idle;
+}
+
+bool idleActive() {
+    return idle;
+}
+
+void idleSleep() {
+    if (!idle) return;
+#if defined(__arm__)
+    // serial, USB and the 1 ms systick all raise interrupts, so this never
+    // sleeps past the next scheduler check
+    asm volatile("wfi");
+#endif
+}
+
+void idleScreensaverTick() {
+    if (!idle || !idleScreensaver || !PING_IDLE) return;
+    unsigned long now = millis();
+    if (now - lastTwinkleMs < IDLE_TWINKLE_MS) return;
+    lastTwinkleMs = now;
+
+    int x = prngRange(TOTAL_WIDTH);
+    int row = prngRange(TOTAL_HEIGHT);
+    addPixelRGB_soft(canvasIndex(x, row), STAR_R * 0.15f, STAR_G * 0.15f, STAR_B * 0.15f);
+}
+
+unsigned long idleFrames() {
+    return skippedFrames;
+}
@@ -0,0 +1,103 @@
+#include "lod.h"
+#include "config.h"
+#include "log.h"
+
+// Cheapest-to-lose detail goes first: long trails, then the blending of faint
+// trail segments, then the faintest stars, then faint trail pixels altogether
+static const LodLimits lodTable[LOD_LEVELS] = {
+    { 255,  0,  0,  0 },    // 0: full detail
+    {   6,  0,  0,  0 },    // 1: long trails capped
+    {   3,  0,  0,  0 },    // 2: short trails
+    {   3, 48,  0,  0 },    // 3: faint segments snap to one pixel
+    {   2, 48,  0, 40 },    // 4: faintest stars dropped
+    {   2, 48, 16, 40 },    // 5: faint trail pixels skipped
+    {   1, 64, 32, 96 },    // 6: heads only, dim stars dropped
+};
+
+LodLimits lodLimits = lodTable[0];
+
+static uint8_t level = 0;
+static bool adaptive = true;
+static uint32_t overBudget = 0;      // consecutive frames over budget
+static uint32_t underBudget = 0;     // consecutive frames with headroom
+static unsigned long changes = 0;
+
+// A restore that overruns again straight away doubles the wait before the
+// next one (up to LOD_BACKOFF_MAX times); a restore that holds halves it.
+static uint32_t restoreDelay = LOD_DOWN_FRAMES;
+static uint32_t sinceRestore = 0xFFFFFFFFu;   // frames since the last step down
+
+static void applyLevel(uint8_t next) {
+    if (next >= LOD_LEVELS) next = LOD_LEVELS - 1;
+    if (next == level) return;
+    LOG_INFO("lod %u -> %u", level, next);
+    level = next;
+    lodLimits = lodTable[level];
+    overBudget = 0;
+    underBudget = 0;
+    changes++;
+}
+
+
+void lodUpdate(unsigned long frameUs, unsigned long periodUs) {
+    if (!adaptive) return;
+    unsigned long budget = periodUs * LOD_BUDGET_PCT / 100;
+    unsigned long restore = periodUs * LOD_RESTORE_PCT / 100;
+
+    // the gap between budget and restore is the hysteresis band: a level
+    // that just fixed an overrun is not undone by the headroom it created
+    if (sinceRestore != 0xFFFFFFFFu && ++sinceRestore == restoreDelay) {
+        if (restoreDelay > LOD_DOWN_FRAMES) restoreDelay >>= 1;
+        sinceRestore = 0xFFFFFFFFu;
+    }
+
+    if (frameUs > budget) {
+        underBudget = 0;
+        if (++overBudget >= LOD_UP_FRAMES && level + 1 < LOD_LEVELS) {
+            if (sinceRestore < restoreDelay && restoreDelay < (uint32_t)LOD_DOWN_FRAMES * LOD_BACKOFF_MAX) {
+                restoreDelay <<= 1;
+            }
+            sinceRestore = 0xFFFFFFFFu;
+            applyLevel(level + 1);
+        }
+    } else if (frameUs < restore) {
+        overBudget = 0;
+        if (++underBudget >= restoreDelay && level > 0) {
+            applyLevel(level - 1);
+            sinceRestore = 0;
+        }
+    } else {
+        overBudget = 0;
+        underBudget = 0;
+    }
+}
+
+
+uint8_t lodLevel() {
+    return level;
+}
+
+
+void lodSetLevel(uint8_t next) {
+    adaptive = false;
+    applyLevel(next);
+}
+
+
+void lodSetAuto(bool enabled) {
+    adaptive = enabled;
+    overBudget = 0;
+    underBudget = 0;
+    restoreDelay = LOD_DOWN_FRAMES;
+    sinceRestore = 0xFFFFFFFFu;
+}
+
+
+bool lodAuto() {
+    return adaptive;
+}
+
+
+unsigned long lodChanges() {
+    return changes;
+}
@@ -0,0 +1,79 @@
+#include "log.h"
+#include "config.h"
+
+#include <stdarg.h>
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two");
+
+// Single producer (main loop), single consumer (logDrain). head and tail only
+// ever increase; their difference is the queued byte count.
+static char ring[LOG_RING_SIZE];
+static volatile uint32_t head = 0;   // written by logWrite
+static volatile uint32_t tail = 0;   // written by logDrain
+static volatile uint32_t dropped = 0;
+static uint32_t droppedReported = 0;
+
+static const char levelTag[] = "?EWID";
+
+static bool enqueue(const char *line, uint32_t len) {
+    uint32_t h = head;
+    uint32_t t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+    if (LOG_RING_SIZE - (h - t) < len) return false;
+    for (uint32_t i = 0; i < len; i++) {
+        ring[(h + i) & (LOG_RING_SIZE - 1)] = line[i];
+    }
+    __atomic_store_n(&head, h + len, __ATOMIC_RELEASE);
+    return true;
+}
+
+void logWrite(uint8_t level, const char *fmt, ...) {
+    char line[LOG_LINE_MAX + 2];
+    line[0] = levelTag[level < sizeof(levelTag) - 1 ? level : 0];
+    line[1] = ':';
+    line[2] = ' ';
+
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(line + 3, LOG_LINE_MAX - 3, fmt, args);
+    va_end(args);
+    if (n < 0) return;
+
+    uint32_t len = 3 + ((uint32_t)n < LOG_LINE_MAX - 4 ? (uint32_t)n : LOG_LINE_MAX - 4);
+    line[len++] = '\r';
+    line[len++] = '\n';
+
+    if (!enqueue(line, len)) dropped++;
+}
+
+void logDrain() {
+    if (dropped != droppedReported) {
+        char note[48];
+        int n = snprintf(note, sizeof(note), "W: log dropped %lu messages\r\n", (unsigned long)(dropped - droppedReported));
+        if (n > 0 && enqueue(note, (uint32_t)n)) droppedReported = dropped;
+    }
+
+    uint32_t t = tail;
+    uint32_t h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    while (h != t) {
+        int room = LogSerial.availableForWrite();
+        if (room <= 0) break;
+
+        // contiguous run up to the end of the ring
+        uint32_t start = t & (LOG_RING_SIZE - 1);
+        uint32_t run = h - t;
+        if (run > LOG_RING_SIZE - start) run = LOG_RING_SIZE - start;
+        if (run > (uint32_t)room) run = (uint32_t)room;
+
+        LogSerial.write((const uint8_t*)ring + start, run);
+        t += run;
+        __atomic_store_n(&tail, t, __ATOMIC_RELEASE);
+    }
+}
+
+uint32_t logDroppedCount() {
+    return dropped;
+}
+
+uint32_t logQueuedBytes() {
+    return head - tail;
+}
@@ -1,8 +1,18 @@
 #include "config.h"
 #include "octo_wrapper.h"
 #include "renderer.h"
+#include "mapping.h"
 #include "stars.h"
 #include "command_handler.h"
+#include "frame_scheduler.h"
+#include "log.h"
+#include "profiler.h"
+#include "idle.h"
+#include "shard.h"
+#include "easing.h"
+#include "tween.h"
+#include "lod.h"
+#include "prng.h"
 #include "../lib/PingPong.cpp"
 
 unsigned long lastMicros = 0;
@@ -11,14 +21,27 @@ void setup() {
   PingPong.init(30000, &Serial1);
   commandHandlerInit();
 
+  mappingBuild();
+  easingInit();
+  prngSeedBoot();
   rendererInit();
   starsInit();
   octoBegin();
+  shardInit();
 
+  profilerInit();
   lastMicros = micros();
+  frameSchedulerInit();
 }
 
-extern void updateClimaxEffects();
+// Work done in frame slack: commands first, then debug output, then sleep
+// until the next interrupt if there is nothing to render
+static void frameSlackWork() {
+  processSerialCommands();
+  shardPoll();
+  logDrain();
+  idleSleep();
+}
 
 void loop() {
   PingPong.update();
@@ -33,18 +56,48 @@ void loop() {
   lastMicros = now;
   if (dt > 0.1f) dt = 0.1f;
 
-  updateClimaxEffects();
+  // sharded nodes all step the same fixed dt so positions agree at the seams
+  shardBeginFrame();
+  if (shardEnabled()) dt = shardFrameDt();
+
+  // Nothing to draw and black already shown: skip the frame until a command
+  if (idleUpdate()) {
+    idleScreensaverTick();
+    frameSchedulerEndFrame(now);
+    frameSchedulerWait(frameSlackWork);
+    return;
+  }
+
+  uint32_t frameStart = profilerNow();
+  uint32_t t = frameStart;
+
+  // animation tracks (climax effects) update the star modulators
+  tweenUpdate(shardClockMs());
+  t = profilerLap(PROF_CLIMAX, t);
 
   fadeBuffer();
+  t = profilerLap(PROF_FADE, t);
   updateAndRenderStars(dt);
-  copyBufferToOcto();
-  octoShow();
-  // TODO Add idle state
-  // if (PING_IDLE) {
-  //   Serial.println("No ping ping");
-  // }
-
-  unsigned long frameMicros = micros() - now;
-  unsigned long targetMicros = frameTargetMs * 1000UL;
-  delay(10);
+  t = profilerLap(PROF_STARS, t);
+  // a black frame that is already on the LEDs needs no copy or transmit
+  if (rendererNeedsShow()) {
+    copyBufferToOcto();
+    t = profilerLap(PROF_COPY, t);
+    octoShow();
+    rendererFrameShown();
+    profilerLap(PROF_SHOW, t);
+  } else {
+    t = profilerLap(PROF_COPY, t);
+    profilerLap(PROF_SHOW, t);
+  }
+  // climax + fade + stars + copy: the part of the frame detail can shorten
+  uint32_t renderCycles = t - frameStart;
+  profilerEndFrame(frameStart);
+
+  frameSchedulerEndFrame(now);
+  // trade detail for frame rate when rendering runs over budget; the show
+  // (DMA wait) and serial work are left out, fewer pixels would not help them
+  lodUpdate(profilerCyclesToUs(renderCycles), frameSchedulerPeriodUs());
+  // Spend the slack until the next frame deadline polling serial
+  frameSchedulerWait(frameSlackWork);
 }
@@ -0,0 +1,135 @@
+#include "mapping.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static_assert(NUM_PIXELS <= 65536, "pixelMap entries are 16-bit");
+
+uint16_t pixelMap[TOTAL_HEIGHT * TOTAL_WIDTH];
+
+// Custom tables, allocated on first load: strip position per cell
+static uint16_t *customMap[CURTAINS];
+
+// Table being loaded, and how many entries have arrived
+static uint16_t *staged = nullptr;
+static int stagedCurtain = -1;
+static int stagedCount = 0;
+
+static const char *const wiringNames[WIRING_COUNT] = {
+    "COLUMN_MAJOR", "ROW_MAJOR", "SERPENTINE_COLUMNS", "SERPENTINE_ROWS", "CUSTOM"
+};
+
+// Index of (col, row) within one curtain for the given wiring
+static int wiredLocalIndex(int curtain, CurtainWiring wiring, int col, int row) {
+    switch (wiring) {
+        case WIRING_CUSTOM:
+            if (customMap[curtain]) return customMap[curtain][localIndexInCurtain(col, row)];
+            return localIndexInCurtain(col, row);
+        case WIRING_ROW_MAJOR:
+            return row * CURTAIN_WIDTH + col;
+        case WIRING_SERPENTINE_COLUMNS:
+            return col * CURTAIN_HEIGHT + ((col & 1) ? (CURTAIN_HEIGHT - 1 - row) : row);
+        case WIRING_SERPENTINE_ROWS:
+            return row * CURTAIN_WIDTH + ((row & 1) ? (CURTAIN_WIDTH - 1 - col) : col);
+        case WIRING_COLUMN_MAJOR:
+        default:
+            return localIndexInCurtain(col, row);
+    }
+}
+
+void mappingBuild() {
+    for (int row = 0; row < TOTAL_HEIGHT; row++) {
+        for (int x = 0; x < TOTAL_WIDTH; x++) {
+            int curtain = x / CURTAIN_WIDTH;
+            int col = x % CURTAIN_WIDTH;
+            int rowOut = invertCurtain[curtain] ? (CURTAIN_HEIGHT - 1 - row) : row;
+            int localIndex = wiredLocalIndex(curtain, curtainWiring[curtain], col, rowOut);
+            pixelMap[row * TOTAL_WIDTH + x] = (uint16_t)globalOctoIndex(curtain, localIndex);
+        }
+    }
+}
+
+bool mappingSetCurtain(int curtainIdx, CurtainWiring wiring, bool invert) {
+    if (curtainIdx < 0 || curtainIdx >= CURTAINS) return false;
+    if (wiring >= WIRING_COUNT) return false;
+    if (wiring == WIRING_CUSTOM && !customMap[curtainIdx]) return false;
+    curtainWiring[curtainIdx] = wiring;
+    invertCurtain[curtainIdx] = invert;
+    mappingBuild();
+    return true;
+}
+
+static void dropStaged() {
+    free(staged);
+    staged = nullptr;
+    stagedCurtain = -1;
+    stagedCount = 0;
+}
+
+bool mappingLoadCustom(int curtainIdx, int offset, const uint16_t *entries, int count, bool &applied) {
+    applied = false;
+    if (curtainIdx < 0 || curtainIdx >= CURTAINS || count <= 0) return false;
+
+    // offset 0 starts a table; anything else must continue the one in progress
+    if (offset == 0) {
+        if (!staged) staged = (uint16_t *)malloc(LEDS_PER_CURTAIN * sizeof(uint16_t));
+        if (!staged) return false;
+        stagedCurtain = curtainIdx;
+        stagedCount = 0;
+    }
+    if (!staged || curtainIdx != stagedCurtain || offset != stagedCount ||
+        offset + count > LEDS_PER_CURTAIN) {
+        dropStaged();
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (entries[i] >= LEDS_PER_CURTAIN) {
+            dropStaged();
+            return false;
+        }
+        staged[offset + i] = entries[i];
+    }
+    stagedCount += count;
+    if (stagedCount < LEDS_PER_CURTAIN) return true;
+
+    // complete: a position used twice would leave another LED dark
+    uint8_t seen[(LEDS_PER_CURTAIN + 7) / 8];
+    memset(seen, 0, sizeof(seen));
+    for (int i = 0; i < LEDS_PER_CURTAIN; i++) {
+        uint16_t p = staged[i];
+        if (seen[p >> 3] & (1 << (p & 7))) {
+            dropStaged();
+            return false;
+        }
+        seen[p >> 3] |= 1 << (p & 7);
+    }
+
+    // the finished table becomes the curtain's; the old one is reused for staging
+    uint16_t *old = customMap[curtainIdx];
+    customMap[curtainIdx] = staged;
+    staged = old;
+    stagedCurtain = -1;
+    stagedCount = 0;
+    curtainWiring[curtainIdx] = WIRING_CUSTOM;
+    mappingBuild();
+    applied = true;
+    return true;
+}
+
+bool mappingHasCustom(int curtainIdx) {
+    return curtainIdx >= 0 && curtainIdx < CURTAINS && customMap[curtainIdx];
+}
+
+const char *wiringName(CurtainWiring wiring) {
+    return wiring < WIRING_COUNT ? wiringNames[wiring] : "UNKNOWN";
+}
+
+bool wiringFromName(const char *name, CurtainWiring &out) {
+    for (int i = 0; i < WIRING_COUNT; i++) {
+        if (strcmp(name, wiringNames[i]) == 0) {
+            out = (CurtainWiring)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -1,7 +1,7 @@
 #include "../include/octo_wrapper.h"
 
-DMAMEM int displayMemory[LEDS_PER_CURTAIN * 6];
-int drawingMemory[LEDS_PER_CURTAIN * 6];
+DMAMEM int displayMemory[OCTO_MEMORY_WORDS];
+int drawingMemory[OCTO_MEMORY_WORDS];
 const int config_flags = WS2811_RGB | WS2811_800kHz;
 
 OctoWS2811 leds(LEDS_PER_CURTAIN, displayMemory, drawingMemory, config_flags, CURTAINS, (byte*)pinList);
@@ -18,4 +18,25 @@ void octoShow() {
 
 void octoSetPixel(int globalIdx, uint8_t r, uint8_t g, uint8_t b) {
     leds.setPixel(globalIdx, r, g, b);
-}
\ No newline at end of file
+}
+
+uint8_t *octoDrawBuffer() {
+#ifdef OCTO_ZERO_COPY
+    return (uint8_t*)drawingMemory;
+#else
+    return nullptr;
+#endif
+}
+
+void octoWriteCurtain(int curtainIdx, const uint8_t *rgb) {
+#ifdef OCTO_ZERO_COPY
+    uint8_t *dst = (uint8_t*)drawingMemory + (size_t)curtainIdx * LEDS_PER_CURTAIN * 3;
+    if (dst != rgb) memcpy(dst, rgb, (size_t)LEDS_PER_CURTAIN * 3);
+#else
+    // bit-transposed layout: the driver has to pack every pixel itself
+    int globalIdx = curtainIdx * LEDS_PER_CURTAIN;
+    for (int i = 0; i < LEDS_PER_CURTAIN; i++, rgb += 3) {
+        leds.setPixel(globalIdx + i, rgb[0], rgb[1], rgb[2]);
+    }
+#endif
+}
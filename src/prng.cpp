@@ -0,0 +1,48 @@
+#include "prng.h"
+#include "config.h"
+
+PrngState prng = { 0x853c49e6748fea9bULL, 0xda3e39cb94b95bdbULL };
+
+static uint32_t seedValue = 0;
+
+void prngSeed(uint32_t seed) {
+    seedValue = seed;
+    // standard PCG32 seeding: fixed stream, state advanced past the seed
+    prng.state = 0;
+    prng.inc = (0xda3e39cb94b95bdbULL << 1) | 1;
+    prngNext();
+    prng.state += seed;
+    prngNext();
+}
+
+
+uint32_t prngSeedValue() {
+    return seedValue;
+}
+
+
+void prngSeedBoot() {
+    uint32_t seed = prngBootSeed;
+    if (!seed) seed = (uint32_t)analogRead(A0) ^ (uint32_t)micros();
+    prngSeed(seed);
+}
+
+
+uint32_t prngRangeFrom(uint32_t word, uint32_t n) {
+    if (n == 0) return 0;
+    uint64_t m = (uint64_t)word * n;
+    uint32_t low = (uint32_t)m;
+    if (low < n) {
+        uint32_t threshold = (uint32_t)(-n) % n;
+        while (low < threshold) {
+            m = (uint64_t)prngNext() * n;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+
+void prngFill(uint32_t *out, int n) {
+    for (int i = 0; i < n; i++) out[i] = prngNext();
+}
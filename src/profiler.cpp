@@ -0,0 +1,90 @@
+#include "profiler.h"
+
+static_assert((PROFILER_WINDOW & (PROFILER_WINDOW - 1)) == 0, "PROFILER_WINDOW must be a power of two");
+
+static uint32_t samples[PROF_STAGE_COUNT][PROFILER_WINDOW];
+static uint32_t slot = 0;       // window index the current frame writes to
+static uint32_t filled = 0;     // valid samples per stage, up to PROFILER_WINDOW
+
+static const char *const stageNames[PROF_STAGE_COUNT] = {
+    "climax", "fade", "stars", "copy", "show", "frame"
+};
+
+void profilerInit() {
+#ifdef ARM_DWT_CTRL
+    // the Teensy 4 core normally enables this already
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+#endif
+    profilerReset();
+}
+
+uint32_t profilerLap(ProfileStage stage, uint32_t since) {
+    uint32_t now = ARM_DWT_CYCCNT;
+    samples[stage][slot] = now - since;
+    return now;
+}
+
+void profilerEndFrame(uint32_t frameStart) {
+    samples[PROF_FRAME][slot] = ARM_DWT_CYCCNT - frameStart;
+    slot = (slot + 1) & (PROFILER_WINDOW - 1);
+    if (filled < PROFILER_WINDOW) filled++;
+}
+
+void profilerReset() {
+    memset(samples, 0, sizeof(samples));
+    slot = 0;
+    filled = 0;
+}
+
+void profilerSummary(ProfileStage stage, ProfileSummary &out) {
+    out.samples = filled;
+    out.minCycles = out.avgCycles = out.maxCycles = out.p99Cycles = 0;
+    if (filled == 0) return;
+
+    // the oldest sample sits at `slot` once the window has wrapped
+    uint32_t sorted[PROFILER_WINDOW];
+    uint32_t first = filled < PROFILER_WINDOW ? 0 : slot;
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < filled; i++) {
+        uint32_t v = samples[stage][(first + i) & (PROFILER_WINDOW - 1)];
+        sum += v;
+
+        // insertion sort; the window is small and this only runs on STATS
+        uint32_t j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+
+    out.minCycles = sorted[0];
+    out.maxCycles = sorted[filled - 1];
+    out.avgCycles = (uint32_t)(sum / filled);
+    uint32_t rank = (filled * 99 + 99) / 100;   // ceil(0.99 * n)
+    out.p99Cycles = sorted[rank - 1];
+}
+
+uint32_t profilerLastCycles(ProfileStage stage) {
+    return samples[stage][(slot - 1) & (PROFILER_WINDOW - 1)];
+}
+
+const char *profilerStageName(ProfileStage stage) {
+    return stage < PROF_STAGE_COUNT ? stageNames[stage] : "?";
+}
+
+bool profilerStageFromName(const char *name, ProfileStage &out) {
+    for (uint8_t s = 0; s < PROF_STAGE_COUNT; s++) {
+        if (strcmp(name, stageNames[s]) == 0) {
+            out = (ProfileStage)s;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t profilerCyclesToUs(uint32_t cycles) {
+    uint32_t cyclesPerUs = F_CPU_ACTUAL / 1000000;
+    return cyclesPerUs ? cycles / cyclesPerUs : cycles;
+}
@@ -1,64 +1,313 @@
 #include "../include/renderer.h"
 #include "../include/octo_wrapper.h"
+#include "../include/mapping.h"
+#include "../include/log.h"
+#include <string.h>
 
+// Canvas: NUM_PIXELS * 3 channels, row-major over the whole wall (index
+// row * TOTAL_WIDTH + x, see canvasIndex()), 12.4 fixed point (16 = one 8-bit
+// step). Stars accumulate here with saturating integer adds and fade is a Q16
+// multiply, so dim trails keep 4 bits below the LED's LSB. Physical LED order
+// (wiring, invertCurtain) only exists in the output stage, via pixelMap.
+static uint16_t *canvas = nullptr;
+
+// Output bytes, NUM_PIXELS * 3, in OctoWS2811 pixel order. When the driver's
+// drawing buffer is linear this *is* drawingMemory and only falls back to a
+// heap copy on boards where it isn't.
 static uint8_t *pixBuf = nullptr;
+static bool pixBufOwned = false;
+
+#ifdef RENDERER_PIXEL_COUNT
+uint32_t rendererPixelWrites = 0;
+#endif
+
+// Dirty tracking by rows. A segment is the CURTAIN_WIDTH pixels of one row
+// that fall on one curtain (contiguous in the canvas); bit c of rowDirty[r]
+// is set while that span of row r on curtain c may hold non-zero values.
+// addPixelCanvas() sets bits, fadeBuffer() clears them once a span has
+// faded to black.
+#define SEGMENT_PIXELS CURTAIN_WIDTH
+#define ALL_SEGMENTS (CURTAINS == 32 ? 0xFFFFFFFFu : ((1u << CURTAINS) - 1))
+static_assert(CURTAINS <= 32, "row dirty mask is 32 bits");
+static_assert((SEGMENT_PIXELS * 3) % 2 == 0, "segments are faded a word (two channels) at a time");
+
+static uint32_t rowDirty[TOTAL_HEIGHT];
+static uint32_t rowLit[TOTAL_HEIGHT];     // spans written non-black by the last output pass
+static bool shownBlank = false;           // the last shown frame was all black
+
+// Output stage tables. gammaLut maps a canvas value (8.4, clipped to 4095)
+// to an 8.8 output level; the dither threshold supplies the rounding.
+#define GAMMA_LUT_SIZE 4096
+static uint16_t gammaLut[GAMMA_LUT_SIZE];
+static float gammaLutValue = -1.0f;
+static uint32_t outputFrame = 0;
+
+// Power estimate: sum over every channel of its output level (gammaLut, 8.8),
+// kept up to date by addPixelCanvas() and fadeBuffer() so it never needs
+// a rescan except when the gamma table changes.
+#define FULL_LEVEL (255u * 256u)
+static uint32_t levelSum = 0;
+static uint32_t powerScale = 256;       // Q8 scale applied in the output stage
+static uint32_t outputMa = 0;
+
+
+static inline uint32_t channelLevel(uint32_t v) {
+    return gammaLut[v < GAMMA_LUT_SIZE ? v : GAMMA_LUT_SIZE - 1];
+}
 
+// 4x4 Bayer thresholds over (x, row), rotated every frame
+static const uint8_t bayer16[16] = { 0, 8, 2, 10, 12, 4, 14, 6, 3, 11, 1, 9, 15, 7, 13, 5 };
+
+
+// Only runs at init or when outputGamma changes, never per frame
+static void rebuildGammaLut() {
+    const float top = 255.0f * 16.0f;     // canvas value of full 8-bit white
+    for (int i = 0; i < GAMMA_LUT_SIZE; i++) {
+        float v = i >= top ? 1.0f : (float)i / top;
+        if (outputGamma != 1.0f) v = powf(v, outputGamma);
+        gammaLut[i] = (uint16_t)(v * 255.0f * 256.0f + 0.5f);
+    }
+    gammaLutValue = outputGamma;
+
+    // levels changed under the running power sum
+    levelSum = 0;
+    if (canvas) {
+        for (int i = 0; i < NUM_PIXELS * 3; i++) levelSum += channelLevel(canvas[i]);
+    }
+}
+
+
+// Boot-time allocations that share RAM2: the canvas and star store from the
+// heap, OctoWS2811's displayMemory from DMAMEM. Runtime extras (custom wiring
+// tables, the non-Teensy pixBuf) come out of what is left.
+static_assert(CANVAS_BYTES + sizeof(displayMemory) + (size_t)STAR_CAPACITY * STAR_BYTES <= HEAP_RAM_BYTES,
+              "canvas, LED DMA buffer and star store exceed HEAP_RAM_BYTES; lower STAR_CAPACITY or the wall size");
 
 void rendererInit() {
     if (pixBuf) return;
-    pixBuf = (uint8_t*) malloc((size_t)NUM_PIXELS * 3);
+    canvas = (uint16_t*) malloc(CANVAS_BYTES);
+    if (!canvas) {
+        Serial.print("ERROR: not enough RAM for the canvas, bytes: ");
+        Serial.println((unsigned long)CANVAS_BYTES);
+        while (1) delay(1000);
+    }
+    pixBuf = octoDrawBuffer();
+    pixBufOwned = false;
+    if (!pixBuf) {
+        pixBuf = (uint8_t*) malloc((size_t)NUM_PIXELS * 3);
+        pixBufOwned = true;
+    }
     if (!pixBuf) {
         Serial.println("ERROR: not enough RAM for pixBuf");
         while (1) delay(1000);
     }
+    memset(canvas, 0, CANVAS_BYTES);
     memset(pixBuf, 0, (size_t)NUM_PIXELS * 3);
+    // black, but not yet sent to the driver
+    for (int r = 0; r < TOTAL_HEIGHT; r++) rowDirty[r] = 0;
+    rendererInvalidate();
+    rebuildGammaLut();
+    if (powerLimitMa && powerLimitMa <= rendererIdleMa()) {
+        LOG_WARN("powerLimitMa %lu is not above the %lu mA idle draw, limit off",
+                 powerLimitMa, (unsigned long)rendererIdleMa());
+        powerLimitMa = 0;
+    }
+    rendererUpdatePower();
 }
 
 
 void rendererFree() {
-    if (pixBuf) free(pixBuf);
+    if (pixBuf && pixBufOwned) free(pixBuf);
+    if (canvas) free(canvas);
+    canvas = nullptr;
     pixBuf = nullptr;
+    pixBufOwned = false;
+}
+
+
+static inline void addChannel(uint16_t &c, uint32_t add) {
+    if (!add) return;
+    uint32_t s = (uint32_t)c + add;
+    if (s > 0xFFFF) s = 0xFFFF;
+    levelSum += channelLevel(s) - channelLevel(c);
+    c = (uint16_t)s;
+}
+
+static inline uint32_t canvasUnits(float v) {
+    int add = (int)(v * 16.0f);
+    return add > 0 ? (uint32_t)add : 0;
 }
 
+void addPixelCanvas(int canvasIdx, uint32_t r, uint32_t g, uint32_t b) {
+    if (!canvas) return;
+    if (canvasIdx < 0 || canvasIdx >= NUM_PIXELS) return;
+#ifdef RENDERER_PIXEL_COUNT
+    rendererPixelWrites++;
+#endif
+    int seg = canvasIdx / SEGMENT_PIXELS;
+    rowDirty[seg / CURTAINS] |= 1u << (seg % CURTAINS);
 
-void addPixelRGB_soft(int globalPixelIdx, float r, float g, float b) {
-    if (!pixBuf) return;
-    if (globalPixelIdx < 0 || globalPixelIdx >= NUM_PIXELS) return;
-    int base = globalPixelIdx * 3;
-    int v;
+    uint16_t *px = canvas + canvasIdx * 3;
+    addChannel(px[0], r);
+    addChannel(px[1], g);
+    addChannel(px[2], b);
+}
 
-    v = (int)pixBuf[base + 0] + (int)r;
-    if (v > 255) v = 255; pixBuf[base + 0] = (uint8_t)v;
+void addPixelRGB_soft(int canvasIdx, float r, float g, float b) {
+    addPixelCanvas(canvasIdx, canvasUnits(r), canvasUnits(g), canvasUnits(b));
+}
 
-    v = (int)pixBuf[base + 1] + (int)g;
-    if (v > 255) v = 255; pixBuf[base + 1] = (uint8_t)v;
 
-    v = (int)pixBuf[base + 2] + (int)b;
-    if (v > 255) v = 255; pixBuf[base + 2] = (uint8_t)v;
+// Fade n channels by factor (Q16), two channels per 32-bit word; all-black
+// words are skipped. Returns whether any channel is still non-zero. Pairs
+// are loaded and stored with memcpy (a single word access once compiled),
+// which keeps the uint16_t canvas free of type-punned pointers.
+static bool fadeChannels(uint16_t *buf, int n, uint32_t factor) {
+    int wordCount = n >> 1;
+    uint32_t live = 0;
+    uint32_t removed = 0;
+    for (int i = 0; i < wordCount; i++) {
+        uint32_t p;
+        memcpy(&p, buf + 2 * i, sizeof(p));
+        if (!p) continue;
+        uint32_t lo0 = p & 0xFFFF, hi0 = p >> 16;
+        uint32_t lo = (lo0 * factor) >> 16;
+        uint32_t hi = (hi0 * factor) >> 16;
+        removed += channelLevel(lo0) - channelLevel(lo) + channelLevel(hi0) - channelLevel(hi);
+        p = lo | (hi << 16);
+        memcpy(buf + 2 * i, &p, sizeof(p));
+        live |= p;
+    }
+    levelSum -= removed;
+    return live != 0;
 }
 
 
 void fadeBuffer() {
-    if (!pixBuf) return;
-    int total = NUM_PIXELS * 3;
-    for (int i = 0; i < total; i++) {
-        float v = (float)pixBuf[i] * fadeFactor;
-        if (v < 0.5f) v = 0.0f;
-        pixBuf[i] = (uint8_t)min(255.0f, v);
+    if (!canvas) return;
+    float f = fadeFactor < 0.0f ? 0.0f : (fadeFactor > 1.0f ? 1.0f : fadeFactor);
+    uint32_t factor = (uint32_t)(f * 65535.0f + 0.5f);
+    for (int r = 0; r < TOTAL_HEIGHT; r++) {
+        uint32_t mask = rowDirty[r];
+        while (mask) {
+            int c = __builtin_ctz(mask);
+            mask &= mask - 1;
+            int seg = r * CURTAINS + c;
+            if (!fadeChannels(canvas + (size_t)seg * SEGMENT_PIXELS * 3, SEGMENT_PIXELS * 3, factor)) {
+                rowDirty[r] &= ~(1u << c);
+            }
+        }
+    }
+}
+
+
+bool rendererIsBlank() {
+    for (int r = 0; r < TOTAL_HEIGHT; r++) {
+        if (rowDirty[r]) return false;
+    }
+    return true;
+}
+
+
+void rendererInvalidate() {
+    for (int r = 0; r < TOTAL_HEIGHT; r++) rowLit[r] = ALL_SEGMENTS;
+    shownBlank = false;
+}
+
+
+bool rendererNeedsShow() {
+    return !(shownBlank && rendererIsBlank());
+}
+
+
+void rendererFrameShown() {
+    shownBlank = rendererIsBlank();
+}
+
+
+// Gamma + temporal dither + physical mapping for one span of a row: the
+// canvas is read sequentially, the output bytes land wherever the curtain's
+// wiring puts each pixel
+static void outputSegment(int row, int curtain, uint32_t frameRot, uint32_t scale) {
+    int x = curtain * CURTAIN_WIDTH;
+    const uint16_t *src = canvas + (size_t)canvasIndex(x, row) * 3;
+    const uint16_t *map = pixelMapRow(row) + x;
+    uint32_t ditherRow = (uint32_t)(row & 3) << 2;
+
+    for (int i = 0; i < SEGMENT_PIXELS; i++, x++, src += 3) {
+        uint8_t *dst = pixBuf + (size_t)map[i] * 3;
+        uint32_t threshold = outputDither ? (uint32_t)bayer16[((ditherRow | (x & 3)) + frameRot) & 15] * 16 + 8 : 128;
+        for (int ch = 0; ch < 3; ch++) {
+            uint32_t v = src[ch];
+            if (v >= GAMMA_LUT_SIZE) v = GAMMA_LUT_SIZE - 1;
+            uint32_t out = ((((uint32_t)gammaLut[v] * scale) >> 8) + threshold) >> 8;
+            dst[ch] = out > 255 ? 255 : (uint8_t)out;
+        }
+    }
+}
+
+
+uint32_t rendererIdleMa() {
+    return (uint32_t)(((uint64_t)NUM_PIXELS * LED_IDLE_UA) / 1000);
+}
+
+
+uint32_t rendererEstimatedMa() {
+    return rendererIdleMa() + (uint32_t)(((uint64_t)levelSum * LED_CHANNEL_MA) / FULL_LEVEL);
+}
+
+
+uint32_t rendererOutputMa() {
+    return outputMa;
+}
+
+
+float rendererPowerScale() {
+    return powerScale / 256.0f;
+}
+
+
+// Global brightness scale that keeps the estimate within powerLimitMa
+void rendererUpdatePower() {
+    uint32_t idleMa = rendererIdleMa();
+    uint32_t ledMa = (uint32_t)(((uint64_t)levelSum * LED_CHANNEL_MA) / FULL_LEVEL);
+    powerScale = 256;
+    if (powerLimitMa && idleMa + ledMa > powerLimitMa && ledMa > 0) {
+        uint32_t avail = powerLimitMa > idleMa ? powerLimitMa - idleMa : 0;
+        powerScale = (uint32_t)(((uint64_t)avail * 256) / ledMa);
     }
+    outputMa = idleMa + ((ledMa * powerScale) >> 8);
 }
 
 
 void copyBufferToOcto() {
-    if (!pixBuf) return;
-    for (int curtain = 0; curtain < CURTAINS; curtain++) {
-        for (int localIndex = 0; localIndex < LEDS_PER_CURTAIN; localIndex++) {
-            int globalIdx = curtain * LEDS_PER_CURTAIN + localIndex;
-            int base = globalIdx * 3;
-            uint8_t r = pixBuf[base + 0];
-            uint8_t g = pixBuf[base + 1];
-            uint8_t b = pixBuf[base + 2];
-            octoSetPixel(globalIdx, r, g, b);
+    if (!pixBuf || !canvas) return;
+    if (outputGamma != gammaLutValue) rebuildGammaLut();
+    rendererUpdatePower();
+    // each pixel gets a different threshold every frame, cycling through all 16
+    uint32_t frameRot = (outputFrame++ * 5) & 15;
+
+    uint32_t touched = 0;       // curtains with any span written this pass
+    for (int r = 0; r < TOTAL_HEIGHT; r++) {
+        // spans that are lit now, or were lit last time and must go black
+        uint32_t mask = rowDirty[r] | rowLit[r];
+        if (!mask) continue;
+        rowLit[r] = rowDirty[r];
+        touched |= mask;
+
+        while (mask) {
+            int c = __builtin_ctz(mask);
+            mask &= mask - 1;
+            outputSegment(r, c, frameRot, powerScale);
         }
     }
-}
\ No newline at end of file
+
+    // zero-copy: the bytes already are the driver's drawing buffer
+    if (pixBufOwned) {
+        while (touched) {
+            int c = __builtin_ctz(touched);
+            touched &= touched - 1;
+            octoWriteCurtain(c, pixBuf + (size_t)c * LEDS_PER_CURTAIN * 3);
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#include "serial_framer.h"
+#include <string.h>
+
+SerialFramer::Result SerialFramer::push(uint8_t c) {
+    if (pending()) {
+        // callers drain with resume(), but keep byte order if one doesn't:
+        // queued bytes came off the wire before c
+        if (pendingLen == sizeof(pendingBuf)) {
+            pendingLen -= pendingPos;
+            memmove(pendingBuf, pendingBuf + pendingPos, pendingLen);
+            pendingPos = 0;
+        }
+        if (pendingLen < sizeof(pendingBuf)) pendingBuf[pendingLen++] = c;
+        else discarded++;
+        return resume();
+    }
+    return step(c);
+}
+
+SerialFramer::Result SerialFramer::resume() {
+    if (!pending()) return NONE;
+    uint8_t c = pendingBuf[pendingPos++];
+    if (pendingPos == pendingLen) pendingLen = pendingPos = 0;
+    return step(c);
+}
+
+// Drop the 0xB5 that started the current binary frame and queue everything
+// after it to be framed again. The queue never outgrows one binary frame:
+// bytes taken from it only come back minus the magic byte.
+void SerialFramer::rescan() {
+    uint16_t keep = len - 1;
+    uint16_t rest = pendingLen - pendingPos;
+    memmove(pendingBuf + keep, pendingBuf + pendingPos, rest);
+    memcpy(pendingBuf, buf + 1, keep);
+    pendingPos = 0;
+    pendingLen = keep + rest;
+    discarded++;
+    state = HUNT;
+    len = 0;
+}
+
+SerialFramer::Result SerialFramer::step(uint8_t c) {
+    switch (state) {
+        case HUNT:
+            // waiting for the first '!' or the binary magic byte
+            len = 0;
+            if (c == '!') {
+                state = START;
+            } else if (c == BIN_MAGIC) {
+                buf[len++] = (char)c;
+                state = BIN_ID;
+            } else {
+                discarded++;
+            }
+            return NONE;
+
+        case START:
+            if (c == '!') {
+                buf[0] = '!';
+                buf[1] = '!';
+                len = 2;
+                state = BODY;
+                return NONE;
+            }
+            // a lone '!': drop it and look at c afresh
+            discarded++;
+            state = HUNT;
+            return step(c);
+
+        case BODY:
+            // "!!" inside a frame means the previous one was cut off: start over
+            if (c == '!' && len > 2 && buf[len - 1] == '!') {
+                resyncs++;
+                discarded += len - 1;
+                len = 2;
+                return NONE;
+            }
+            if (len >= SERIAL_MAX_FRAME) {
+                overflows++;
+                discarded += len + 1;
+                state = HUNT;
+                len = 0;
+                return TOO_LONG;
+            }
+            buf[len++] = (char)c;
+            if (c == '#' && buf[len - 2] == '#' && len >= 4) {
+                buf[len] = '\0';
+                state = HUNT;
+                return FRAME;
+            }
+            return NONE;
+
+        case BIN_ID:
+            buf[len++] = (char)c;
+            binId = c;
+            crc = crc16Update(0xFFFF, c);
+            state = BIN_LEN;
+            return NONE;
+
+        case BIN_LEN:
+            buf[len++] = (char)c;
+            if (!binHeaderValid(binId, c)) {
+                // not a frame we know: the 0xB5 was noise
+                badHeaders++;
+                rescan();
+                return NONE;
+            }
+            binLen = c;
+            crc = crc16Update(crc, c);
+            state = binLen ? BIN_PAYLOAD : BIN_CRC_LO;
+            return NONE;
+
+        case BIN_PAYLOAD:
+            buf[len++] = (char)c;
+            crc = crc16Update(crc, c);
+            if (len >= 3 + binLen) state = BIN_CRC_LO;
+            return NONE;
+
+        case BIN_CRC_LO:
+            buf[len++] = (char)c;
+            rxCrc = c;
+            state = BIN_CRC_HI;
+            return NONE;
+
+        case BIN_CRC_HI:
+            buf[len++] = (char)c;
+            rxCrc |= (uint16_t)c << 8;
+            state = HUNT;
+            if (rxCrc != crc) {
+                crcErrors++;
+                rescan();
+                return BAD_CRC;
+            }
+            return BINARY;
+    }
+    return NONE;
+}
@@ -0,0 +1,215 @@
+#include "shard.h"
+#include "config.h"
+#include "stars.h"
+#include "frame_scheduler.h"
+#include "serial_framer.h"
+#include "binary_protocol.h"
+#include "log.h"
+
+static SerialFramer linkFramer;
+static uint32_t frameNumber = 0;
+static uint64_t clockUs = 0;       // animation clock, one period per frame
+static bool syncPending = false;   // follower: SYNC for syncFrame not consumed yet
+static uint32_t syncFrame = 0;
+static uint64_t syncClockUs = 0;
+
+static uint32_t starsSent = 0;
+static uint32_t starsReceived = 0;
+static uint32_t syncsReceived = 0;
+static uint32_t linkErrors = 0;
+
+void shardInit() {
+    ShardLinkSerial.begin(SHARD_LINK_BAUD);
+    if (!shardConfigure(nodeIndex, nodeCount, nodeColumnOffset, globalWidth)) {
+        LOG_ERROR("bad node config %u/%u, falling back to a single node", nodeIndex, nodeCount);
+        shardConfigure(0, 1, 0, TOTAL_WIDTH);
+    }
+}
+
+bool shardConfigure(uint8_t index, uint8_t count, int columnOffset, int width) {
+    if (count < 1 || index >= count) return false;
+    if (columnOffset < 0 || columnOffset + TOTAL_WIDTH > width) return false;
+
+    nodeIndex = index;
+    nodeCount = count;
+    nodeColumnOffset = columnOffset;
+    globalWidth = width;
+    syncPending = false;
+    // followers take their frame timing from node 0's SYNC
+    frameSchedulerSetExternalClock(count > 1 && index > 0);
+    return true;
+}
+
+bool shardEnabled() {
+    return nodeCount > 1;
+}
+
+static bool isLastNode() {
+    return nodeIndex == nodeCount - 1;
+}
+
+void shardBeginFrame() {
+    if (!shardEnabled() || nodeIndex == 0) {
+        frameNumber++;
+        clockUs += frameSchedulerPeriodUs();
+        if (!shardEnabled()) return;
+
+        uint8_t p[BIN_SYNC_LEN];
+        binWriteU32(p, frameNumber);
+        binWriteU32(p + 4, frameSchedulerPeriodUs());
+        p[8] = nodeIndex;
+        binWriteU32(p + 9, (uint32_t)clockUs);
+        binWriteU32(p + 13, (uint32_t)(clockUs >> 32));
+        sendBinaryFrame(ShardLinkSerial, BIN_SYNC, p, sizeof(p));
+        return;
+    }
+
+    // free-run on our own clock if node 0's SYNC is late
+    if (syncPending) {
+        frameNumber = syncFrame;
+        clockUs = syncClockUs;
+    } else {
+        frameNumber++;
+        clockUs += frameSchedulerPeriodUs();
+    }
+    syncPending = false;
+}
+
+uint32_t shardFrame() {
+    return frameNumber;
+}
+
+uint32_t shardClockMs() {
+    return (uint32_t)(clockUs / 1000);
+}
+
+bool shardSpawnsStars() {
+    return nodeColumnOffset == 0;
+}
+
+float shardFrameDt() {
+    return frameSchedulerPeriodUs() / 1000000.0f;
+}
+
+
+void shardHandOff(int i) {
+    // leaving the last node goes round the ring to node 0
+    float xGlobal = stars.x[i] + nodeColumnOffset;
+    uint8_t flags = 0;
+    uint8_t passes = stars.passes[i];
+    if (isLastNode()) {
+        if (passes == 1) {
+            // its last pass across the whole canvas: let the trail leave,
+            // nothing goes round
+            stars.flags[i] |= STAR_FLAG_GHOST;
+            starsCountExpired();
+            return;
+        }
+        if (passes) passes--;
+        xGlobal -= globalWidth;
+        if (!wrapStars) flags |= STAR_FLAG_RESPAWN;
+    }
+
+    uint8_t p[BIN_HANDOFF_LEN];
+    binWriteU32(p, frameNumber);
+    binWriteF32(p + 4, xGlobal);
+    binWriteF32(p + 8, stars.vx[i]);
+    binWriteF32(p + 12, stars.bright[i]);
+    p[16] = stars.row[i];
+    p[17] = stars.r[i];
+    p[18] = stars.g[i];
+    p[19] = stars.b[i];
+    p[20] = stars.size[i];
+    p[21] = flags;
+    p[22] = passes;
+    binWriteU32(p + 23, starsTimeLeft(i));
+    p[27] = stars.group[i];
+    sendBinaryFrame(ShardLinkSerial, BIN_STAR_HANDOFF, p, sizeof(p));
+
+    stars.flags[i] |= STAR_FLAG_GHOST;
+    starsSent++;
+}
+
+static void receiveStar(const uint8_t *p, uint8_t len) {
+    if (len != BIN_HANDOFF_LEN) {
+        linkErrors++;
+        return;
+    }
+
+    float x = binReadF32(p + 4) - nodeColumnOffset;
+    float vx = binReadF32(p + 8);
+    // catch up on frames stepped since the sender's frame
+    int32_t lag = (int32_t)(frameNumber - binReadU32(p));
+    if (lag > 0 && lag < 64) x += vx * shardFrameDt() * lag;
+
+    int i = starsInsert(x, vx, binReadF32(p + 12), p[16], p[17], p[18], p[19], p[20]);
+    if (i < 0) {
+        LOG_WARN("handoff dropped, star store full");
+        linkErrors++;
+        return;
+    }
+    if (p[21] & STAR_FLAG_RESPAWN) randomizeStarProperties(i, true);
+    starsSetLifetime(i, p[22], binReadU32(p + 23));
+    stars.group[i] = p[27] & (STAR_GROUPS - 1);
+    starsReceived++;
+}
+
+static void receiveSync(const uint8_t *p, uint8_t len) {
+    if (len != BIN_SYNC_LEN) {
+        linkErrors++;
+        return;
+    }
+    syncsReceived++;
+    if (nodeIndex == 0) return;   // came all the way round
+
+    // pass it on before doing anything else so downstream latency stays low
+    if (!isLastNode()) sendBinaryFrame(ShardLinkSerial, BIN_SYNC, p, len);
+
+    unsigned long periodUs = binReadU32(p + 4);
+    if (periodUs && periodUs != frameSchedulerPeriodUs()) {
+        frameSchedulerSetFps(1000000.0f / (float)periodUs);
+    }
+    syncFrame = binReadU32(p);
+    syncClockUs = binReadU32(p + 9) | ((uint64_t)binReadU32(p + 13) << 32);
+    syncPending = true;
+    frameSchedulerAlign();
+}
+
+static void handleLinkResult(SerialFramer::Result r) {
+    if (r == SerialFramer::BINARY) {
+        if (linkFramer.binaryId() == BIN_STAR_HANDOFF) {
+            receiveStar(linkFramer.payload(), linkFramer.payloadLength());
+        } else if (linkFramer.binaryId() == BIN_SYNC) {
+            receiveSync(linkFramer.payload(), linkFramer.payloadLength());
+        } else {
+            linkErrors++;
+        }
+    } else if (r != SerialFramer::NONE) {
+        linkErrors++;
+    }
+}
+
+void shardPoll() {
+    if (!shardEnabled()) return;
+    int budget = SERIAL_BYTE_BUDGET;
+    while (budget-- > 0 && ShardLinkSerial.available() > 0) {
+        handleLinkResult(linkFramer.push((uint8_t)ShardLinkSerial.read()));
+        while (linkFramer.pending()) handleLinkResult(linkFramer.resume());
+    }
+}
+
+uint32_t shardStarsSent() {
+    return starsSent;
+}
+
+uint32_t shardStarsReceived() {
+    return starsReceived;
+}
+
+uint32_t shardSyncsReceived() {
+    return syncsReceived;
+}
+
+uint32_t shardLinkErrors() {
+    return linkErrors;
+}
@@ -1,154 +1,399 @@
 #include "stars.h"
 #include "renderer.h"
-#include "mapping.h"
+#include "log.h"
+#include "shard.h"
+#include "easing.h"
+#include "lod.h"
+#include "prng.h"
 #include "../include/config.h"
 
+static_assert(CURTAIN_HEIGHT <= 256, "star rows are stored as uint8_t");
+
+#define STAR_RANDOM_WORDS 4   // x, row, speed, brightness
+
 static bool starsAllocated = false;
-Star *starsArr = nullptr;
+static void *starsBlock = nullptr;
+StarStore stars = {};
+StarModulators starMods = { 1.0f, 1.0f, 0.0f, 0.0f, 0.0f };
+StarModulators starGroupMods[STAR_GROUPS];   // set up by starsInit()
+static unsigned long expiredCount = 0;
 unsigned long lastMicros_local = 0;
 
 void starsInit() {
   if (starsAllocated) return;
-  starsArr = (Star*) malloc(sizeof(Star) * MAX_STARS);
-  if (!starsArr) {
+  // one block: 4-byte columns first so they stay aligned
+  size_t n = (size_t)MAX_STARS;
+  starsBlock = malloc(n * STAR_BYTES);
+  if (!starsBlock) {
     Serial.println("ERROR: not enough RAM for stars array");
     while (1) delay(1000);
   }
   starsAllocated = true;
 
-  randomSeed(analogRead(A0) ^ micros());
-  // initialize
-  for (int i = 0; i < MAX_STARS; i++) {
-    randomizeStarProperties(starsArr[i], true);
-    // spread initial x so they don't all appear at once
-    starsArr[i].x = random(0, TOTAL_WIDTH * 100) / 100.0f;
-  }
+  float *f = (float*)starsBlock;
+  stars.x      = f;
+  stars.vx     = f + n;
+  stars.bright = f + 2 * n;
+  stars.expires = (uint32_t*)(f + 3 * n);
+  uint8_t *u = (uint8_t*)(stars.expires + n);
+  stars.row  = u;
+  stars.r    = u + n;
+  stars.g    = u + 2 * n;
+  stars.b    = u + 3 * n;
+  stars.size = u + 4 * n;
+  stars.flags = u + 5 * n;
+  stars.passes = u + 6 * n;
+  stars.group = u + 7 * n;
+
+  starsResetModulators();
+  activeStarCount = 0;
 }
 
 void starsFree() {
-  if (starsArr) free(starsArr);
-  starsArr = nullptr;
+  if (starsBlock) free(starsBlock);
+  starsBlock = nullptr;
+  stars = StarStore();
   starsAllocated = false;
+  activeStarCount = 0;
+}
+
+// Random start for star i from STAR_RANDOM_WORDS pre-drawn words
+static void randomizeFromWords(int i, const uint32_t *w, bool randomRowAllowed) {
+  // start slightly left so the star slides in smoothly
+  stars.x[i] = - (prngRangeFrom(w[0], 50) / 25.0f); // -0 .. -2
+  if (randomRows && randomRowAllowed) stars.row[i] = (uint8_t)prngRangeFrom(w[1], CURTAIN_HEIGHT);
+  else stars.row[i] = 0;
+  int lo = (int)(minSpeedColsPerSec * 100.0f);
+  int hi = (int)(maxSpeedColsPerSec * 100.0f);
+  stars.vx[i] = (hi > lo ? lo + (int)prngRangeFrom(w[2], hi - lo) : lo) / 100.0f;
+  stars.bright[i] = (70 + prngRangeFrom(w[3], 31)) / 100.0f; // 0.70 .. 1.00
+}
+
+void randomizeStarProperties(int i, bool randomRowAllowed) {
+  uint32_t w[STAR_RANDOM_WORDS];
+  prngFill(w, STAR_RANDOM_WORDS);
+  randomizeFromWords(i, w, randomRowAllowed);
+}
+
+
+
+static void resetModulators(StarModulators &m) {
+  m.speedScale = 1.0f;
+  m.brightScale = 1.0f;
+  m.climb = 0.0f;
+  m.wobble = 0.0f;
+  m.wobblePhase = 0.0f;
+}
+
+void starsResetModulators() {
+  resetModulators(starMods);
+  for (int g = 0; g < STAR_GROUPS; g++) resetModulators(starGroupMods[g]);
 }
 
-void randomizeStarProperties(Star &s, bool randomRowAllowed) {
-  s.x = - (random(0, 50) / 25.0f); // -0 .. -2
-  if (randomRows && randomRowAllowed) s.row = random(0, CURTAIN_HEIGHT);
-  else s.row = 0;
-  s.vx = random((int)(minSpeedColsPerSec * 100.0f), (int)(maxSpeedColsPerSec * 100.0f)) / 100.0f;
-  s.bright = random(70, 101) / 100.0f; // 0.70 .. 1.00
-}
-
-
-
-// render a single star into the soft buffer
-static void renderStarToBuffer(const Star &s) {
-  float fx = s.x;
-  int leftCol = (int)floorf(fx);
-  float frac = fx - leftCol;
-  float wl = 1.0f - frac;
-  float wr = frac;
-  float br = s.bright;
-
-  // Process the star and its trail based on size
-  for (int i = 0; i < s.size; i++) {
-    // Calculate brightness falloff for trail
-    float trailFactor = 1.0f - (float)i / s.size;
-    
-    // Position for this trail segment
-    float trailX = fx - i * 0.5f;
-    int trailLeftCol = (int)floorf(trailX);
-    float trailFrac = trailX - trailLeftCol;
-    float trailWl = 1.0f - trailFrac;
-    float trailWr = trailFrac;
-    
-    // Adjusted brightness for trail segment
-    float segmentBr = br * trailFactor;
-    
-    float rL = s.r * segmentBr * trailWl;
-    float gL = s.g * segmentBr * trailWl;
-    float bL = s.b * segmentBr * trailWl;
-    float rR = s.r * segmentBr * trailWr;
-    float gR = s.g * segmentBr * trailWr;
-    float bR = s.b * segmentBr * trailWr;
-
-    // Render left pixel of trail segment
-    if (trailLeftCol >= 0 && trailLeftCol < TOTAL_WIDTH) {
-      int curtainL = trailLeftCol / CURTAIN_WIDTH;
-      int localColL = trailLeftCol % CURTAIN_WIDTH;
-      int row = s.row;
-      if (curtainL >= 0 && curtainL < CURTAINS) {
-        int rowOut = invertCurtain[curtainL] ? (CURTAIN_HEIGHT - 1 - row) : row;
-        int localIndex = localIndexInCurtain(localColL, rowOut);
-        int globalIdx = globalOctoIndex(curtainL, localIndex);
-        addPixelRGB_soft(globalIdx, rL, gL, bL);
+
+// starMods and one group's modulators combined, once per frame
+struct GroupFrame {
+  float step;     // dt * speed scales
+  float bright;
+  float keep;     // 1 - climb
+  float wobble;
+  float phase;
+};
+
+// Row star si is drawn on under its group's climb/wobble
+static inline int modulatedRow(int si, const GroupFrame &m) {
+  float r = (float)stars.row[si] * m.keep
+          + sinTurns(stars.x[si] * (1.0f / TOTAL_WIDTH) + m.phase) * m.wobble
+          + 0.5f;
+  int row = r > 0.0f ? (int)r : 0;
+  return row < CURTAIN_HEIGHT ? row : CURTAIN_HEIGHT - 1;
+}
+
+
+// Render a single star and its trail into the canvas, one write per pixel.
+//
+// The trail is `size` segments spaced half a column apart behind the head,
+// segment i at x - i/2 with brightness 1 - i/size, each spread over its two
+// nearest columns with a linear (tent) weight. Instead of splatting every
+// segment, each covered column's total weight is summed directly: only
+// segments within one column of it contribute, so at most four terms. All
+// positions and weights are Q8 integers. Under level of detail, segments
+// dimmer than snapBelow skip the split and land on their nearest column.
+static void renderStarToBuffer(int si, int row, float brightScale) {
+  float br = stars.bright[si] * brightScale;
+  // Q8; gains above 1 (brightness up to 255 = 2.55) are kept and clip in
+  // the canvas. The cap only keeps colour * weight products inside 32 bits.
+  uint32_t brQ = (uint32_t)(br * 256.0f);
+  if (brQ > 4096) brQ = 4096;
+  uint32_t r = stars.r[si] * brQ, g = stars.g[si] * brQ, b = stars.b[si] * brQ;   // Q8 colour
+  int size = stars.size[si];
+  int rowBase = canvasIndex(0, row);
+
+  // Level of detail: drop faint stars, shorten trails, snap faint segments,
+  // skip faint trail pixels
+  uint32_t peak = r > g ? r : g;
+  if (b > peak) peak = b;
+  if (peak < ((uint32_t)lodLimits.cullBelow << 8)) return;
+  if (size > lodLimits.maxTrail) size = lodLimits.maxTrail;
+  uint32_t snapLimit = (uint32_t)lodLimits.snapBelow << 16;
+  uint32_t faintLimit = (uint32_t)lodLimits.faintBelow << 16;
+
+  // head position in Q8; stars are drawn from x > -2, so the bias keeps the
+  // conversion a floor
+  int32_t xq = (int32_t)((stars.x[si] + 4.0f) * 256.0f) - 1024;
+
+  if (size == 1) {
+    if (peak * 256 < snapLimit) {
+      // faint: one write at full weight on the nearest column
+      int col = (xq + 128) >> 8;
+      if (col >= 0 && col < TOTAL_WIDTH && peak * 256 >= faintLimit) {
+        addPixelCanvas(rowBase + col, r >> 4, g >> 4, b >> 4);
       }
+      return;
+    }
+    // single segment: plain two-pixel split
+    int col = xq >> 8;
+    uint32_t wr = xq & 0xFF;
+    uint32_t wl = 256 - wr;
+    if (col >= 0 && col < TOTAL_WIDTH && peak * wl >= faintLimit) {
+      addPixelCanvas(rowBase + col, (r * wl) >> 12, (g * wl) >> 12, (b * wl) >> 12);
     }
+    col++;
+    if (wr && col >= 0 && col < TOTAL_WIDTH && peak * wr >= faintLimit) {
+      addPixelCanvas(rowBase + col, (r * wr) >> 12, (g * wr) >> 12, (b * wr) >> 12);
+    }
+    return;
+  }
 
-    // Render right pixel of trail segment
-    int trailRightCol = trailLeftCol + 1;
-    if (trailRightCol >= 0 && trailRightCol < TOTAL_WIDTH) {
-      int curtainR = trailRightCol / CURTAIN_WIDTH;
-      int localColR = trailRightCol % CURTAIN_WIDTH;
-      int row = s.row;
-      if (curtainR >= 0 && curtainR < CURTAINS) {
-        int rowOut = invertCurtain[curtainR] ? (CURTAIN_HEIGHT - 1 - row) : row;
-        int localIndex = localIndexInCurtain(localColR, rowOut);
-        int globalIdx = globalOctoIndex(curtainR, localIndex);
-        addPixelRGB_soft(globalIdx, rR, gR, bR);
+  // columns from the tail segment's left pixel to the head's right pixel
+  int last = size - 1;
+  int colLo = (xq - last * 128) >> 8;
+  int colHi = (xq >> 8) + 1;
+  if (colLo < 0) colLo = 0;
+  if (colHi > TOTAL_WIDTH - 1) colHi = TOTAL_WIDTH - 1;
+  uint32_t fadeStep = 65536 / size;                             // Q16 falloff per segment
+
+  // segments from iSnap on are dimmer than snapBelow (falloff only drops)
+  int iSnap = size;
+  if (snapLimit) {
+    iSnap = 0;
+    while (iSnap < size && peak * (256 - ((iSnap * fadeStep + 128) >> 8)) >= snapLimit) iSnap++;
+  }
+
+  for (int col = colLo; col <= colHi; col++) {
+    // segment i contributes while |xq - i*128 - col*256| < 256
+    int32_t d = xq - (col << 8);
+    int iLo = ((d - 256) >> 7) + 1;
+    int iHi = (d + 255) >> 7;
+    if (iLo < 0) iLo = 0;
+    if (iHi > last) iHi = last;
+
+    uint32_t w = 0;                                             // Q8, up to 512
+    for (int i = iLo; i <= iHi; i++) {
+      int32_t dist = d - i * 128;
+      uint32_t falloff = 256 - ((i * fadeStep + 128) >> 8);
+      if (i >= iSnap) {
+        // snapped: all of it on the nearest column, none on the other
+        if (dist >= -128 && dist < 128) w += falloff;
+        continue;
       }
+      uint32_t tent = 256 - (uint32_t)(dist < 0 ? -dist : dist);
+      w += (tent * falloff + 128) >> 8;
     }
+    if (!w || peak * w < faintLimit) continue;
+    addPixelCanvas(rowBase + col, (r * w) >> 12, (g * w) >> 12, (b * w) >> 12);
   }
 }
 
 void updateAndRenderStars(float dt) {
-  if (!starsArr) return;
-  for (int i = 0; i < activeStarCount; i++) {
-    Star &s = starsArr[i];
-    s.x += s.vx * dt;
-    if (s.x > -2.0f && s.x < TOTAL_WIDTH + 2.0f) {
-      renderStarToBuffer(s);
+  if (!starsAllocated) return;
+  int n = activeStarCount;
+
+  GroupFrame mods[STAR_GROUPS];
+  bool rowsModulated = false;
+  for (int g = 0; g < STAR_GROUPS; g++) {
+    const StarModulators &gm = starGroupMods[g];
+    float climb = starMods.climb + gm.climb;
+    if (climb > 1.0f) climb = 1.0f;
+    mods[g].step = dt * starMods.speedScale * gm.speedScale;
+    mods[g].bright = starMods.brightScale * gm.brightScale;
+    mods[g].keep = 1.0f - climb;
+    mods[g].wobble = starMods.wobble + gm.wobble;
+    mods[g].phase = starMods.wobblePhase + gm.wobblePhase;
+    if (climb != 0.0f || mods[g].wobble != 0.0f) rowsModulated = true;
+  }
+
+  // Integrate positions: flat arrays and a four-entry step table, no branches
+  float *__restrict x = stars.x;
+  const float *__restrict vx = stars.vx;
+  const uint8_t *__restrict group = stars.group;
+  for (int i = 0; i < n; i++) {
+    x[i] += vx[i] * mods[group[i]].step;
+  }
+
+  bool sharded = shardEnabled();
+  uint32_t now = shardClockMs();
+  for (int i = 0; i < n; i++) {
+    // TTL ran out: despawn; slot i now holds a star not yet drawn this frame
+    if (stars.expires[i] && (int32_t)(now - stars.expires[i]) >= 0) {
+      starsRemove(i);
+      expiredCount++;
+      i--;
+      n--;
+      continue;
     }
-    if (s.x > TOTAL_WIDTH + 1.0f) {
-      if (wrapStars) {
-        s.x -= (TOTAL_WIDTH + 2.0f);
+
+    float tail = x[i] - (stars.size[i] - 1) * 0.5f;
+    if (x[i] > -2.0f && tail < TOTAL_WIDTH) {
+      const GroupFrame &m = mods[stars.group[i]];
+      renderStarToBuffer(i, rowsModulated ? modulatedRow(i, m) : stars.row[i], m.bright);
+    }
+    if (sharded) {
+      // hand off just before the head reaches the next node's first column,
+      // then keep drawing the trail here until it has crossed the seam
+      if (!(stars.flags[i] & STAR_FLAG_GHOST)) {
+        if (x[i] > TOTAL_WIDTH - 2.0f) shardHandOff(i);
+      } else if (tail >= TOTAL_WIDTH) {
+        starsRemove(i);   // slot i now holds a star not yet drawn this frame
+        i--;
+        n--;
+      }
+    } else if (x[i] > TOTAL_WIDTH + 1.0f) {
+      if (stars.passes[i] && --stars.passes[i] == 0) {
+        // last pass done: despawn instead of coming round again
+        starsRemove(i);
+        expiredCount++;
+        i--;
+        n--;
+      } else if (wrapStars) {
+        x[i] -= (TOTAL_WIDTH + 2.0f);
       } else {
-        randomizeStarProperties(s, true);
+        randomizeStarProperties(i, true);
       }
     }
   }
 }
 
-bool addStar(float speed = -1, int hexColor = -1, int brightness = -1, int size = -1) {
-  Star &s = starsArr[activeStarCount];
-  randomizeStarProperties(s, true);
-
+// Apply the caller's overrides to freshly randomized star i
+static void applySpawnOptions(int i, float speed, int hexColor, int brightness, int size,
+                              uint8_t passes, uint32_t ttlMs) {
   if (speed != -1) {
-    s.vx = speed;
+    stars.vx[i] = speed;
   }
 
   if (hexColor != -1) {
-    Serial.println("hexColor");
-    Serial.println(hexColor);
-    s.r = (hexColor >> 16) & 0xFF;  // Integer value 0-255
-    s.g = (hexColor >> 8) & 0xFF;   // Integer value 0-255
-    s.b = hexColor & 0xFF;
-    Serial.println("Color");
-    Serial.println(s.r);
-    Serial.println(s.g);
-    Serial.println(s.b);
+    stars.r[i] = (hexColor >> 16) & 0xFF;  // Integer value 0-255
+    stars.g[i] = (hexColor >> 8) & 0xFF;   // Integer value 0-255
+    stars.b[i] = hexColor & 0xFF;
+    LOG_DEBUG("star %d color 0x%06x -> r=%u g=%u b=%u", i, hexColor, stars.r[i], stars.g[i], stars.b[i]);
+  } else {
+    stars.r[i] = STAR_R;
+    stars.g[i] = STAR_G;
+    stars.b[i] = STAR_B;
   }
 
   if (brightness != -1) {
-    s.bright = brightness / 100.0f;
+    stars.bright[i] = brightness / 100.0f;
   }
 
-  if (size != -1) {
-    s.size = size;
+  stars.size[i] = (size != -1) ? (uint8_t)size : 1;
+  stars.flags[i] = 0;
+  starsSetLifetime(i, passes, ttlMs);
+}
+
+bool addStar(float speed, int hexColor, int brightness, int size, uint8_t passes, uint32_t ttlMs, int group) {
+  return starsSpawn(1, speed, hexColor, brightness, size, passes, ttlMs, group) == 1;
+}
+
+int starsSpawn(int count, float speed, int hexColor, int brightness, int size, uint8_t passes, uint32_t ttlMs,
+               int group) {
+  // sharded: stars enter at the wall's left edge only and are handed on
+  if (!starsAllocated || !shardSpawnsStars()) return 0;
+  uint32_t words[STAR_SPAWN_CHUNK * STAR_RANDOM_WORDS];
+  int added = 0;
+  while (added < count && activeStarCount < MAX_STARS) {
+    int chunk = count - added;
+    if (chunk > STAR_SPAWN_CHUNK) chunk = STAR_SPAWN_CHUNK;
+    if (chunk > MAX_STARS - activeStarCount) chunk = MAX_STARS - activeStarCount;
+    // one pass over the generator for the whole chunk, then plain stores
+    prngFill(words, chunk * STAR_RANDOM_WORDS);
+    for (int k = 0; k < chunk; k++) {
+      int i = activeStarCount;
+      const uint32_t *w = words + k * STAR_RANDOM_WORDS;
+      randomizeFromWords(i, w, true);
+      applySpawnOptions(i, speed, hexColor, brightness, size, passes, ttlMs);
+      // random group from the x word's low bits (the x draw uses its high bits)
+      stars.group[i] = group >= 0 ? (uint8_t)group : (uint8_t)(w[0] & (STAR_GROUPS - 1));
+      activeStarCount++;
+    }
+    added += chunk;
   }
+  return added;
+}
 
-  // start slightly left so the star slides in smoothly
-  s.x = - (random(0, 50) / 25.0f);
-  activeStarCount++;
-  return true;
-}
\ No newline at end of file
+int starsInsert(float x, float vx, float bright, uint8_t row, uint8_t r, uint8_t g, uint8_t b, uint8_t size) {
+  if (!starsAllocated || activeStarCount >= MAX_STARS) return -1;
+  int i = activeStarCount++;
+  stars.x[i] = x;
+  stars.vx[i] = vx;
+  stars.bright[i] = bright;
+  stars.row[i] = row < CURTAIN_HEIGHT ? row : CURTAIN_HEIGHT - 1;
+  stars.r[i] = r;
+  stars.g[i] = g;
+  stars.b[i] = b;
+  stars.size[i] = size ? size : 1;
+  stars.flags[i] = 0;
+  stars.passes[i] = 0;
+  stars.expires[i] = 0;
+  stars.group[i] = 0;
+  return i;
+}
+
+void starsSetLifetime(int i, uint8_t passes, uint32_t ttlMs) {
+  stars.passes[i] = passes;
+  uint32_t expires = 0;
+  if (ttlMs) {
+    expires = shardClockMs() + ttlMs;
+    if (!expires) expires = 1;   // 0 means no TTL
+  }
+  stars.expires[i] = expires;
+}
+
+uint32_t starsTimeLeft(int i) {
+  if (!stars.expires[i]) return 0;
+  int32_t left = (int32_t)(stars.expires[i] - shardClockMs());
+  return left > 0 ? (uint32_t)left : 1;
+}
+
+unsigned long starsExpired() {
+  return expiredCount;
+}
+
+void starsCountExpired() {
+  expiredCount++;
+}
+
+// O(1) removal: the last live star takes over slot i
+void starsRemove(int i) {
+  if (i < 0 || i >= activeStarCount) return;
+  int last = activeStarCount - 1;
+  if (i != last) {
+    stars.x[i]      = stars.x[last];
+    stars.vx[i]     = stars.vx[last];
+    stars.bright[i] = stars.bright[last];
+    stars.row[i]    = stars.row[last];
+    stars.r[i]      = stars.r[last];
+    stars.g[i]      = stars.g[last];
+    stars.b[i]      = stars.b[last];
+    stars.size[i]   = stars.size[last];
+    stars.flags[i]  = stars.flags[last];
+    stars.passes[i] = stars.passes[last];
+    stars.expires[i] = stars.expires[last];
+    stars.group[i]  = stars.group[last];
+  }
+  activeStarCount = last;
+}
+
+void starsClear() {
+  activeStarCount = 0;
+}
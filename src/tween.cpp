@@ -0,0 +1,112 @@
+#include "tween.h"
+#include "log.h"
+#include "shard.h"
+#include <string.h>
+
+struct TweenTrack {
+    const char *name;       // not copied; callers pass string literals
+    float *target;
+    TweenKey keys[TWEEN_MAX_KEYS];
+    uint8_t keyCount;
+    uint8_t seg;            // current segment: keys[seg] -> keys[seg + 1]
+    bool active;
+    unsigned long startMs;
+    unsigned long durationMs;
+    TweenDone onDone;
+};
+
+static TweenTrack tracks[TWEEN_MAX_TRACKS];
+static int activeTracks = 0;
+
+static int findTrack(const char *name) {
+    for (int i = 0; i < TWEEN_MAX_TRACKS; i++) {
+        if (tracks[i].active && strcmp(tracks[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+static void freeTrack(int i) {
+    tracks[i].active = false;
+    activeTracks--;
+}
+
+
+int tweenStart(const char *name, float *target, const TweenKey *keys, uint8_t keyCount,
+               unsigned long durationMs, TweenDone onDone) {
+    if (!name || !target || !keys || keyCount == 0 || keyCount > TWEEN_MAX_KEYS) return -1;
+    for (int k = 1; k < keyCount; k++) {
+        if (keys[k].at < keys[k - 1].at) return -1;
+    }
+
+    int slot = findTrack(name);
+    if (slot < 0) {
+        for (int i = 0; i < TWEEN_MAX_TRACKS; i++) {
+            if (!tracks[i].active) { slot = i; break; }
+        }
+        if (slot < 0) {
+            LOG_WARN("tween pool full, dropped track %s", name);
+            return -1;
+        }
+        activeTracks++;
+    }
+
+    TweenTrack &t = tracks[slot];
+    t.name = name;
+    t.target = target;
+    memcpy(t.keys, keys, keyCount * sizeof(TweenKey));
+    t.keyCount = keyCount;
+    t.seg = 0;
+    t.active = true;
+    t.startMs = shardClockMs();
+    t.durationMs = durationMs;
+    t.onDone = onDone;
+    *target = keys[0].value;
+    return slot;
+}
+
+
+bool tweenStop(const char *name) {
+    int i = findTrack(name);
+    if (i < 0) return false;
+    freeTrack(i);
+    return true;
+}
+
+
+int tweenActiveCount() {
+    return activeTracks;
+}
+
+
+void tweenUpdate(unsigned long nowMs) {
+    if (!activeTracks) return;
+    for (int i = 0; i < TWEEN_MAX_TRACKS; i++) {
+        TweenTrack &t = tracks[i];
+        if (!t.active) continue;
+
+        unsigned long elapsed = nowMs - t.startMs;
+        float pos = (t.durationMs > 0 && elapsed < t.durationMs) ? (float)elapsed / t.durationMs : 1.0f;
+
+        // segments only move forward, so this is one step per key at most
+        while (t.seg + 1 < t.keyCount - 1 && pos >= t.keys[t.seg + 1].at) t.seg++;
+
+        if (t.keyCount == 1 || pos >= 1.0f) {
+            *t.target = t.keys[t.keyCount - 1].value;
+        } else {
+            const TweenKey &a = t.keys[t.seg];
+            const TweenKey &b = t.keys[t.seg + 1];
+            float span = b.at - a.at;
+            float local = span > 0.0f ? (pos - a.at) / span : 1.0f;
+            if (local < 0.0f) local = 0.0f;
+            if (local > 1.0f) local = 1.0f;
+            *t.target = a.value + (b.value - a.value) * easeApply(b.ease, local);
+        }
+
+        if (pos >= 1.0f) {
+            // free first: the callback may start new tracks, even in this slot
+            TweenDone done = t.onDone;
+            freeTrack(i);
+            if (done) done();
+        }
+    }
+}